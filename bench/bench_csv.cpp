@@ -0,0 +1,114 @@
+// CSV ingestion benchmark
+//
+// Usage: bench_csv [rows | file.csv]
+//
+// Without a file argument a CSV export of the requested number of rows
+// (default 1000000) is generated in a temporary file: an id, two number
+// columns, a category and a free-text note that is quoted on some rows.
+// Each available scanner backend reads the file with read_csv semantics
+// and its throughput is reported, then a reduction over a column read
+// through the interpreter is timed.
+
+#include "csv_reader.hpp"
+#include "interpreter.hpp"
+#include "scanner.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace pangea;
+
+namespace
+{
+    void generateCsv(const std::string &path, std::size_t rows)
+    {
+        static const char *categories[] = {"hardware", "garden", "kitchen", "toys", "books"};
+        static const char *notes[] = {
+            "standard delivery",
+            "\"fragile, handle with care\"",
+            "returned once",
+            "\"customer said \"\"thanks\"\"\"",
+        };
+
+        std::ofstream file(path, std::ios::binary);
+        file << "id,price,quantity,category,note\n";
+        std::string row;
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            row = std::to_string(i) + ',' + std::to_string(i % 1000) + '.' + std::to_string(i % 97) + ',' +
+                  std::to_string(i % 13) + ',' + categories[i % 5] + ',' + notes[i % 4] + '\n';
+            file << row;
+        }
+    }
+
+    template <typename Function>
+    double seconds(Function &&function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string path;
+    bool generated = false;
+    if (argc > 1 && std::atof(argv[1]) == 0.0)
+    {
+        path = argv[1];
+    }
+    else
+    {
+        auto rows = static_cast<std::size_t>(argc > 1 ? std::atof(argv[1]) : 1e6);
+        path = (std::filesystem::temp_directory_path() / "pangea_bench.csv").string();
+        generateCsv(path, rows);
+        generated = true;
+    }
+
+    const double bytes = static_cast<double>(std::filesystem::file_size(path));
+    std::cout << "Input: " << bytes / (1024.0 * 1024.0) << " MiB\n";
+
+    std::size_t rows = 0;
+    for (auto backend : {Scanner::Backend::Scalar, Scanner::Backend::SSE2, Scanner::Backend::AVX2})
+    {
+        if (!Scanner::isSupported(backend))
+        {
+            std::cout << Scanner::getBackendName(backend) << ": not supported\n";
+            continue;
+        }
+        Scanner::setBackend(backend);
+
+        double best = 0.0;
+        for (int run = 0; run < 3; ++run)
+        {
+            double elapsed = seconds([&]
+                                     {
+                Value table = CsvReader::read(path);
+                const Object &columns = table.asObject();
+                rows = columns.empty() ? 0 : columns.valueAt(0).arraySize(); });
+            best = run == 0 || elapsed < best ? elapsed : best;
+        }
+        std::cout << Scanner::getBackendName(backend) << ": " << bytes / best / 1e6 << " MB/s, "
+                  << best * 1e9 / static_cast<double>(rows) << " ns/row (" << rows << " rows)\n";
+    }
+
+    // Reading and reducing a column from a script
+    Scanner::setBackend(Scanner::getBestBackend());
+    Interpreter interpreter;
+    std::string program = "sum get read_csv \"" + path + "\" \"price\"";
+    Value total;
+    double elapsed = seconds([&]
+                             { total = interpreter.execute(program); });
+    std::cout << "script: " << program << " = " << total << " in " << elapsed * 1e3 << " ms\n";
+
+    if (generated)
+    {
+        std::filesystem::remove(path);
+    }
+    return 0;
+}
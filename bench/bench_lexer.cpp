@@ -0,0 +1,94 @@
+// Tokenizer throughput benchmark
+//
+// Usage: bench_lexer [megabytes | file.pangea]
+//
+// Without a file argument a .pangea program of the requested size
+// (default 64 MiB) is generated in memory. Each available scanner
+// backend tokenizes the same buffer and its throughput is reported.
+
+#include "parser.hpp"
+#include "scanner.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace pangea;
+
+namespace
+{
+    std::string generateSource(std::size_t bytes)
+    {
+        static const char *lines[] = {
+            "# Scoring rule generated from the nightly export\n",
+            "println plus \"customer \" get record \"name\"\n",
+            "    if greater times weight 0.75 threshold \"accept\" \"reject\" # inline note\n",
+            "print plus plus \"a string with spaces and a # hash\" \" \" 12345.678\n",
+            "        and less score 100 not equal status \"closed\"\n",
+            "set config \"key_with_a_rather_long_name\" divide total count\n",
+        };
+
+        std::string source;
+        source.reserve(bytes + 128);
+        for (std::size_t i = 0; source.size() < bytes; ++i)
+        {
+            source += lines[i % (sizeof(lines) / sizeof(lines[0]))];
+        }
+        return source;
+    }
+
+    std::string readSource(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string source;
+    if (argc > 1 && std::atof(argv[1]) == 0.0)
+    {
+        source = readSource(argv[1]);
+    }
+    else
+    {
+        double megabytes = argc > 1 ? std::atof(argv[1]) : 64.0;
+        source = generateSource(static_cast<std::size_t>(megabytes * 1024 * 1024));
+    }
+
+    std::cout << "Input: " << source.size() / (1024.0 * 1024.0) << " MiB\n";
+
+    for (auto backend : {Scanner::Backend::Scalar, Scanner::Backend::SSE2, Scanner::Backend::AVX2})
+    {
+        if (!Scanner::isSupported(backend))
+        {
+            std::cout << Scanner::getBackendName(backend) << ": not supported\n";
+            continue;
+        }
+        Scanner::setBackend(backend);
+
+        double best = 0.0;
+        std::size_t tokens = 0;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            tokens = Parser::tokenize(source).size();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double throughput = source.size() / elapsed.count() / 1e9;
+            best = throughput > best ? throughput : best;
+        }
+
+        std::cout << Scanner::getBackendName(backend) << ": " << best << " GB/s (" << tokens << " tokens)\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Loop engine benchmark
+//
+// Usage: bench_loop [iterations]
+//
+// Runs times_loop and each with a small body in both execution modes and
+// reports the time and the heap allocations per iteration. The loops
+// reuse their frame and the operand stack, so allocations per iteration
+// should print as 0.
+
+#include "interpreter.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+
+using namespace pangea;
+
+namespace
+{
+    std::size_t allocations = 0;
+
+    template <typename Function>
+    double seconds(Function &&function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+int main(int argc, char *argv[])
+{
+    std::string count = argc > 1 ? argv[1] : "10000000";
+    double iterations = std::atof(count.c_str());
+
+    // Each loop is the prefix, the iteration count and the suffix
+    const std::pair<std::string, std::string> loops[] = {
+        {"times_loop ", " plus index 1"},
+        {"times_loop ", " if less index 0 stop plus index 1"},
+        {"each range 0 ", " plus value 1"},
+        {"each map range 0 ", " \"times\" 2 plus key value"}};
+
+    for (auto mode : {Interpreter::ExecutionMode::Bytecode, Interpreter::ExecutionMode::TreeWalk})
+    {
+        Interpreter interpreter;
+        interpreter.setExecutionMode(mode);
+        std::cout << (mode == Interpreter::ExecutionMode::Bytecode ? "bytecode" : "tree-walk") << ":\n";
+
+        for (const auto &[prefix, suffix] : loops)
+        {
+            // Short runs first grow the stacks the loop reuses, then count
+            // the allocations of parsing and compiling, which the long run
+            // repeats once
+            std::string warmup = prefix + "10" + suffix;
+            interpreter.execute(warmup);
+            std::size_t before = allocations;
+            interpreter.execute(warmup);
+            std::size_t setup = allocations - before;
+
+            std::string program = prefix + count + suffix;
+            before = allocations;
+            double elapsed = seconds([&]
+                                     { interpreter.execute(program); });
+            double perIteration = (static_cast<double>(allocations - before) - static_cast<double>(setup)) / iterations;
+            std::cout << "  " << program << ": " << elapsed * 1e9 / iterations << " ns/iteration, "
+                      << perIteration << " allocations/iteration\n";
+        }
+    }
+    return 0;
+}
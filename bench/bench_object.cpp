@@ -0,0 +1,155 @@
+// Dictionary object benchmark
+//
+// Usage: bench_object [keys]
+//
+// Compares the FlatMap behind large Pangea objects with the
+// std::unordered_map<std::string, Value> objects used to be stored in:
+// time to insert the keys, to look each of them up, to look up absent
+// keys and to iterate, plus the heap bytes each map holds once built.
+
+#include "flat_map.hpp"
+#include "value.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace pangea;
+
+namespace
+{
+    std::size_t allocatedBytes = 0;
+
+    template <typename Function>
+    double seconds(Function &&function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    void report(const char *name, std::size_t count, double insert, double hit, double miss, double iterate, std::size_t bytes)
+    {
+        std::cout << name << ": insert " << insert * 1e9 / count << " ns, "
+                  << "lookup " << hit * 1e9 / count << " ns, "
+                  << "miss " << miss * 1e9 / count << " ns, "
+                  << "iterate " << iterate * 1e9 / count << " ns per key, "
+                  << bytes / (1024.0 * 1024.0) << " MiB\n";
+    }
+} // namespace
+
+// Track live heap bytes so the maps' memory use can be compared; each
+// block is prefixed with its size
+void *operator new(std::size_t size)
+{
+    auto *block = static_cast<std::size_t *>(std::malloc(size + 16));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    block[0] = size;
+    allocatedBytes += size;
+    return reinterpret_cast<char *>(block) + 16;
+}
+
+void operator delete(void *memory) noexcept
+{
+    if (memory)
+    {
+        auto *block = reinterpret_cast<std::size_t *>(static_cast<char *>(memory) - 16);
+        allocatedBytes -= block[0];
+        std::free(block);
+    }
+}
+
+void operator delete(void *memory, std::size_t) noexcept { operator delete(memory); }
+
+int main(int argc, char *argv[])
+{
+    std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1000000;
+
+    // Keys long enough to defeat the small string optimization, as in
+    // typical dictionary data
+    std::vector<std::string> keys;
+    std::vector<std::string> absent;
+    keys.reserve(count);
+    absent.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        keys.push_back("customer-record-" + std::to_string(i * 7919));
+        absent.push_back("missing-record-" + std::to_string(i * 7919));
+    }
+    std::cout << "Keys: " << count << "\n";
+
+    {
+        std::unordered_map<std::string, Value> map;
+        double sum = 0.0;
+        std::size_t before = allocatedBytes;
+        double insert = seconds([&]
+                                {
+                                    for (std::size_t i = 0; i < count; ++i)
+                                    {
+                                        map.emplace(keys[i], Value(static_cast<double>(i)));
+                                    } });
+        std::size_t bytes = allocatedBytes - before;
+        double hit = seconds([&]
+                             {
+                                 for (const std::string &key : keys)
+                                 {
+                                     sum += map.find(key)->second.asNumber();
+                                 } });
+        double miss = seconds([&]
+                              {
+                                  for (const std::string &key : absent)
+                                  {
+                                      sum += map.count(key);
+                                  } });
+        double iterate = seconds([&]
+                                 {
+                                     for (const auto &[key, value] : map)
+                                     {
+                                         sum += value.asNumber();
+                                     } });
+        report("unordered_map", count, insert, hit, miss, iterate, bytes);
+        std::cout << "  (checksum " << sum << ")\n";
+    }
+
+    {
+        FlatMap<Value> map;
+        double sum = 0.0;
+        std::size_t before = allocatedBytes;
+        double insert = seconds([&]
+                                {
+                                    for (std::size_t i = 0; i < count; ++i)
+                                    {
+                                        map.insert(keys[i], Value(static_cast<double>(i)));
+                                    } });
+        std::size_t bytes = allocatedBytes - before;
+        double hit = seconds([&]
+                             {
+                                 for (const std::string &key : keys)
+                                 {
+                                     sum += map.valueAt(map.find(key)).asNumber();
+                                 } });
+        double miss = seconds([&]
+                              {
+                                  for (const std::string &key : absent)
+                                  {
+                                      sum += map.find(key) == FlatMap<Value>::NotFound ? 0 : 1;
+                                  } });
+        double iterate = seconds([&]
+                                 {
+                                     for (const auto &entry : map)
+                                     {
+                                         sum += entry.value.asNumber();
+                                     } });
+        report("flat map", count, insert, hit, miss, iterate, bytes);
+        std::cout << "  (checksum " << sum << ")\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Output flush policy benchmark
+//
+// Usage: bench_output [lines] [file]
+//
+// Prints the given number of lines with println under each flush policy,
+// into a file (by default /dev/null) through a FileSink with the
+// interpreter's block size, as the default sink on standard output does,
+// and reports the time per line. Line flushes the file on every println,
+// so it pays a write per line; Block and Explicit write whole blocks.
+
+#include "interpreter.hpp"
+#include "output_sink.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+using namespace pangea;
+
+namespace
+{
+    template <typename Function>
+    double seconds(Function &&function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::string count = argc > 1 ? argv[1] : "1000000";
+    std::string path = argc > 2 ? argv[2] : "/dev/null";
+    double lines = std::atof(count.c_str());
+
+    const std::pair<const char *, Interpreter::FlushPolicy> policies[] = {
+        {"line", Interpreter::FlushPolicy::Line},
+        {"block", Interpreter::FlushPolicy::Block},
+        {"explicit", Interpreter::FlushPolicy::Explicit}};
+
+    std::string program = "times_loop " + count + " println index";
+    for (const auto &[name, policy] : policies)
+    {
+        int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file < 0)
+        {
+            std::cerr << "Cannot open " << path << "\n";
+            return 1;
+        }
+
+        double elapsed = seconds([&]
+                                 {
+            Interpreter interpreter;
+            interpreter.setOutput(std::make_unique<FileSink>(file, Interpreter::OutputBlockSize, true));
+            interpreter.setFlushPolicy(policy);
+            interpreter.execute(program); });
+        std::cout << "  " << name << ": " << elapsed * 1e9 / lines << " ns/line\n";
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Reduction kernel benchmark
+//
+// Usage: bench_reduce [max elements]
+//
+// Times sum, min, max, mean, count_if, dot and argmax over packed arrays
+// of 10^3, 10^6 and 10^8 doubles (sizes above the argument are skipped;
+// the largest needs about 1.6 GB), on every VectorMath backend the CPU
+// supports. Small sizes are repeated so each timing covers about 10^8
+// elements.
+
+#include "vector_math.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace pangea;
+
+namespace
+{
+    template <typename Function>
+    double seconds(Function &&function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // Keeps results alive so the reductions are not optimized away
+    volatile double sink;
+
+    template <typename Function>
+    void measure(const char *name, std::size_t size, std::size_t repeats, Function &&function)
+    {
+        double elapsed = seconds([&]
+                                 {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+                sink = static_cast<double>(function());
+            } });
+        std::size_t elements = size * repeats;
+        std::cout << "  " << name << ": " << elapsed * 1e9 / elements << " ns/element, "
+                  << elements * sizeof(double) / elapsed / 1e9 << " GB/s\n";
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::size_t maxSize = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 100000000;
+
+    for (std::size_t size : {std::size_t(1000), std::size_t(1000000), std::size_t(100000000)})
+    {
+        if (size > maxSize)
+        {
+            continue;
+        }
+
+        std::vector<double> a(size), b(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            a[i] = static_cast<double>((i * 2654435761u) % 1000) * 0.001;
+            b[i] = static_cast<double>(i % 7) - 3.0;
+        }
+        std::size_t repeats = size >= 100000000 ? 1 : 100000000 / size;
+
+        for (auto backend : {VectorMath::Backend::Scalar, VectorMath::Backend::SSE2, VectorMath::Backend::AVX2})
+        {
+            if (!VectorMath::isSupported(backend))
+            {
+                continue;
+            }
+            VectorMath::setBackend(backend);
+            std::cout << size << " elements, " << VectorMath::getBackendName(backend) << ":\n";
+
+            measure("sum", size, repeats, [&]
+                    { return VectorMath::sum(a.data(), size); });
+            measure("min", size, repeats, [&]
+                    { return VectorMath::min(a.data(), size); });
+            measure("max", size, repeats, [&]
+                    { return VectorMath::max(a.data(), size); });
+            measure("mean", size, repeats, [&]
+                    { return VectorMath::sum(a.data(), size) / static_cast<double>(size); });
+            measure("count_if", size, repeats, [&]
+                    { return VectorMath::countNonZero(b.data(), size); });
+            measure("dot", size, repeats, [&]
+                    { return VectorMath::dot(a.data(), b.data(), size); });
+            measure("argmax", size, repeats, [&]
+                    { return VectorMath::argmax(a.data(), size); });
+        }
+        VectorMath::setBackend(VectorMath::getBestBackend());
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// Value representation benchmark
+//
+// Usage: bench_value [count]
+//
+// Compares the NaN-boxed pangea::Value against a replica of the previous
+// layout (a std::variant plus a separate type tag). For each layout it
+// reports the size of one value, the cost of copying a vector of mixed
+// values (numbers, booleans and strings) and the cost of summing a
+// vector of numbers, which is dominated by cache footprint.
+
+#include "value.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+using namespace pangea;
+
+namespace
+{
+    // The representation Value had before it was NaN-boxed
+    struct LegacyValue
+    {
+        using Array = std::vector<LegacyValue>;
+        using Object = std::unordered_map<std::string, LegacyValue>;
+
+        Value::Type type = Value::Type::Null;
+        std::variant<std::monostate, double, std::string, bool, Array, Object, std::shared_ptr<FunctionEntry>> data;
+
+        LegacyValue() = default;
+        explicit LegacyValue(double value) : type(Value::Type::Number), data(value) {}
+        explicit LegacyValue(bool value) : type(Value::Type::Boolean), data(value) {}
+        explicit LegacyValue(const std::string &value) : type(Value::Type::String), data(value) {}
+
+        double asNumber() const { return std::get<double>(data); }
+    };
+
+    template <typename Function>
+    double bestSeconds(Function &&function)
+    {
+        double best = 1e30;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = elapsed.count() < best ? elapsed.count() : best;
+        }
+        return best;
+    }
+
+    template <typename V>
+    void run(const char *name, std::size_t count)
+    {
+        std::vector<V> mixed;
+        std::vector<V> numbers;
+        mixed.reserve(count);
+        numbers.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            switch (i % 4)
+            {
+            case 0:
+                mixed.emplace_back(std::string("a string value longer than SSO"));
+                break;
+            case 1:
+                mixed.emplace_back(i % 8 == 1);
+                break;
+            default:
+                mixed.emplace_back(static_cast<double>(i));
+                break;
+            }
+            numbers.emplace_back(static_cast<double>(i));
+        }
+
+        std::size_t copied = 0;
+        double copySeconds = bestSeconds([&]
+                                         {
+                                             std::vector<V> copy = mixed;
+                                             copied += copy.size(); });
+
+        double sum = 0.0;
+        double sumSeconds = bestSeconds([&]
+                                        {
+                                            for (const V &value : numbers)
+                                            {
+                                                sum += value.asNumber();
+                                            } });
+
+        std::cout << name << ": " << sizeof(V) << " bytes/value, "
+                  << (sizeof(V) * count) / (1024.0 * 1024.0) << " MiB per array, "
+                  << "copy " << copySeconds * 1e9 / count << " ns/value, "
+                  << "sum " << sumSeconds * 1e9 / count << " ns/value"
+                  << " (checksum " << sum + copied << ")\n";
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 4000000;
+    std::cout << "Values: " << count << "\n";
+
+    run<LegacyValue>("variant", count);
+    run<Value>("nan-boxed", count);
+
+    return 0;
+}
@@ -9,7 +9,7 @@ CXX_FLAGS="-std=c++20 -Wall -Wextra -pedantic -g -O0"
 INCLUDES="-Iinclude"
 
 # Source files
-SOURCES="src/main.cpp src/value.cpp src/parser.cpp src/interpreter.cpp src/function_entry.cpp"
+SOURCES="src/main.cpp src/value.cpp src/object.cpp src/parser.cpp src/scanner.cpp src/vector_math.cpp src/sequence.cpp src/output_sink.cpp src/input_source.cpp src/mapped_file.cpp src/csv_reader.cpp src/table.cpp src/symbol_table.cpp src/interpreter.cpp src/vm.cpp src/function_entry.cpp"
 
 # Build the executable
 echo "Compiling with g++..."
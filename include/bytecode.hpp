@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace pangea
+{
+
+    class FunctionEntry; // Forward declaration
+
+    /**
+     * @brief Operation codes understood by the interpreter's stack VM
+     */
+    enum class OpCode : std::uint8_t
+    {
+        PushConst,   // Push the constant pool entry `operand` onto the operand stack
+        Call,        // Pop argc values, call functions[operand], push the result
+        CallSpecial, // Call the special form functions[operand] on the argc phrases after `site`, push the result
+        Pop          // Discard the top of the operand stack
+    };
+
+    /**
+     * @brief A single bytecode instruction
+     *
+     * `operand` indexes the interpreter's constant pool (PushConst) or the
+     * resolved function table (Call, CallSpecial). `argc` and `site`, the
+     * index of the function's word in the program, are only meaningful for
+     * calls.
+     */
+    struct Instruction
+    {
+        OpCode op;
+        std::uint32_t argc;
+        std::uint32_t operand;
+        std::uint32_t site;
+    };
+
+    /**
+     * @brief Compiled form of a parsed Pangea program
+     *
+     * Produced from the word stream and its phrase lengths. Function calls
+     * are emitted in postfix order after their arguments, so the program
+     * can be run by a simple dispatch loop over a value stack. Literal
+     * operands refer to the constant pool built when the words were parsed.
+     *
+     * The argument phrases of special forms are not part of `code`: each
+     * is compiled into its own block of `phraseCode`, found through the
+     * phrase's first word, and run whenever the special form evaluates it.
+     */
+    struct Bytecode
+    {
+        /**
+         * @brief Instructions of one phrase within phraseCode
+         */
+        struct Block
+        {
+            std::uint32_t begin = 0;
+            std::uint32_t end = 0;
+        };
+
+        std::vector<Instruction> code;
+        std::vector<Instruction> phraseCode;
+        std::vector<const FunctionEntry *> functions;
+        int firstWord = 0;         // Word index of blocks[0]
+        std::vector<Block> blocks; // By word index, for phrases starting there
+
+        void clear()
+        {
+            code.clear();
+            phraseCode.clear();
+            functions.clear();
+            firstWord = 0;
+            blocks.clear();
+        }
+    };
+
+} // namespace pangea
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "value.hpp"
+#include <string>
+#include <string_view>
+
+namespace pangea
+{
+
+    /**
+     * @brief Reader for delimited text (CSV, TSV) into columns
+     *
+     * The first record names the columns; the result is an object mapping
+     * each name to the column's values, in header order. A column whose
+     * fields are all numbers (or empty) becomes a packed number array, with
+     * NaN for the empty fields; any other column becomes a string array
+     * stored as one StringColumn. Either way a column costs its data and
+     * not one Value per field.
+     *
+     * Fields follow RFC 4180: they may be quoted, a quoted field may hold
+     * delimiters, line breaks and doubled quotes, and records end with
+     * "\n" or "\r\n". Unquoted fields are delimited with the bitmasks of
+     * Scanner::fieldStops, which classifies the text 64 bytes at a time
+     * with the vector backends. Blank lines are skipped, and records
+     * shorter than the header leave their last fields empty.
+     */
+    class CsvReader
+    {
+    public:
+        /**
+         * @brief Parse text held in memory
+         * @throws std::runtime_error on a malformed quoted field or a
+         * record longer than the header
+         */
+        static Value parse(std::string_view text, char delimiter = ',');
+
+        /**
+         * @brief Parse a file, mapped rather than read when possible
+         * @throws std::runtime_error if it cannot be read or parsed
+         */
+        static Value read(const std::string &path, char delimiter = ',');
+    };
+
+} // namespace pangea
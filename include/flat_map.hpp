@@ -0,0 +1,221 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace pangea
+{
+
+    /**
+     * @brief Open-addressing hash map from strings to T, in the style of a
+     * Swiss table, that iterates in insertion order
+     *
+     * Entries (key, cached hash, value) are stored contiguously in insertion
+     * order. The hash table itself holds one control byte and one 32-bit
+     * entry index per bucket: the control byte is either Empty or the low
+     * 7 bits of the key's hash, so a probe compares 16 control bytes at once
+     * (with SSE2 where available) and only touches entries whose byte
+     * matches. Growing re-inserts the cached hashes without rehashing keys.
+     *
+     * Entries cannot be removed; they are addressed by their insertion
+     * index, which stays valid for the lifetime of the map.
+     */
+    template <typename T>
+    class FlatMap
+    {
+    public:
+        static constexpr std::uint32_t NotFound = UINT32_MAX;
+
+        struct Entry
+        {
+            std::string key;
+            std::size_t hash;
+            T value;
+        };
+
+        std::size_t size() const { return entries_.size(); }
+        bool empty() const { return entries_.empty(); }
+
+        const std::string &keyAt(std::uint32_t index) const { return entries_[index].key; }
+        const T &valueAt(std::uint32_t index) const { return entries_[index].value; }
+        T &valueAt(std::uint32_t index) { return entries_[index].value; }
+
+        // Entries in insertion order
+        typename std::vector<Entry>::const_iterator begin() const { return entries_.begin(); }
+        typename std::vector<Entry>::const_iterator end() const { return entries_.end(); }
+
+        /**
+         * @brief Make room for `count` entries without further growth
+         */
+        void reserve(std::size_t count)
+        {
+            entries_.reserve(count);
+            if (count > capacityFor(bucketCount()))
+            {
+                rehash(bucketsFor(count));
+            }
+        }
+
+        /**
+         * @brief Index of the entry for a key, or NotFound
+         */
+        std::uint32_t find(std::string_view key) const
+        {
+            return entries_.empty() ? NotFound : find(key, hashKey(key));
+        }
+
+        /**
+         * @brief Add an entry unless the key is present
+         * @return The key's entry index and whether it was added
+         */
+        std::pair<std::uint32_t, bool> insert(std::string_view key, T value)
+        {
+            const std::size_t hash = hashKey(key);
+            if (!entries_.empty())
+            {
+                std::uint32_t existing = find(key, hash);
+                if (existing != NotFound)
+                {
+                    return {existing, false};
+                }
+            }
+
+            if (entries_.size() + 1 > capacityFor(bucketCount()))
+            {
+                rehash(bucketsFor(entries_.size() + 1));
+            }
+
+            const auto index = static_cast<std::uint32_t>(entries_.size());
+            entries_.push_back({std::string(key), hash, std::move(value)});
+            place(hash, index);
+            return {index, true};
+        }
+
+        /**
+         * @brief Approximate heap bytes used, excluding key and value payloads
+         */
+        std::size_t memoryUsage() const
+        {
+            return entries_.capacity() * sizeof(Entry) + control_.capacity() + indices_.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        static constexpr std::size_t GroupWidth = 16;
+        static constexpr std::int8_t Empty = -128;
+
+        std::vector<Entry> entries_;
+        std::vector<std::int8_t> control_;   // One byte per bucket, plus a mirrored first group
+        std::vector<std::uint32_t> indices_; // Entry index per bucket
+
+        static std::size_t hashKey(std::string_view key) { return std::hash<std::string_view>{}(key); }
+        static std::int8_t tagOf(std::size_t hash) { return static_cast<std::int8_t>(hash & 0x7F); }
+
+        std::size_t bucketCount() const { return indices_.size(); }
+
+        // Maximum load factor of 7/8
+        static std::size_t capacityFor(std::size_t buckets) { return buckets - buckets / 8; }
+
+        static std::size_t bucketsFor(std::size_t count)
+        {
+            std::size_t buckets = GroupWidth;
+            while (capacityFor(buckets) < count)
+            {
+                buckets *= 2;
+            }
+            return buckets;
+        }
+
+        // Bit i of the result is set when byte i of the group equals `tag`
+        static std::uint32_t match(const std::int8_t *group, std::int8_t tag)
+        {
+#if defined(__SSE2__)
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < GroupWidth; ++i)
+            {
+                mask |= static_cast<std::uint32_t>(group[i] == tag) << i;
+            }
+            return mask;
+#endif
+        }
+
+        void setControl(std::size_t bucket, std::int8_t tag)
+        {
+            control_[bucket] = tag;
+            // The first group is mirrored past the end so a group can be
+            // loaded at any bucket without wrapping
+            if (bucket < GroupWidth)
+            {
+                control_[bucket + bucketCount()] = tag;
+            }
+        }
+
+        std::uint32_t find(std::string_view key, std::size_t hash) const
+        {
+            const std::size_t mask = bucketCount() - 1;
+            const std::int8_t tag = tagOf(hash);
+
+            // Triangular probing over groups visits every bucket of a
+            // power-of-two table
+            std::size_t position = (hash >> 7) & mask;
+            for (std::size_t step = GroupWidth;; step += GroupWidth)
+            {
+                const std::int8_t *group = control_.data() + position;
+                for (std::uint32_t hits = match(group, tag); hits != 0; hits &= hits - 1)
+                {
+                    std::size_t bucket = (position + static_cast<std::size_t>(std::countr_zero(hits))) & mask;
+                    const Entry &entry = entries_[indices_[bucket]];
+                    if (entry.hash == hash && entry.key == key)
+                    {
+                        return indices_[bucket];
+                    }
+                }
+                if (match(group, Empty) != 0)
+                {
+                    return NotFound;
+                }
+                position = (position + step) & mask;
+            }
+        }
+
+        void place(std::size_t hash, std::uint32_t index)
+        {
+            const std::size_t mask = bucketCount() - 1;
+            std::size_t position = (hash >> 7) & mask;
+            for (std::size_t step = GroupWidth;; step += GroupWidth)
+            {
+                std::uint32_t empty = match(control_.data() + position, Empty);
+                if (empty != 0)
+                {
+                    std::size_t bucket = (position + static_cast<std::size_t>(std::countr_zero(empty))) & mask;
+                    setControl(bucket, tagOf(hash));
+                    indices_[bucket] = index;
+                    return;
+                }
+                position = (position + step) & mask;
+            }
+        }
+
+        void rehash(std::size_t buckets)
+        {
+            control_.assign(buckets + GroupWidth, Empty);
+            indices_.assign(buckets, 0);
+            for (std::uint32_t index = 0; index < entries_.size(); ++index)
+            {
+                place(entries_[index].hash, index);
+            }
+        }
+    };
+
+} // namespace pangea
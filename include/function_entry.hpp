@@ -3,8 +3,11 @@
 #include "value.hpp"
 #include <functional>
 #include <vector>
+#include <span>
 #include <string>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 namespace pangea
 {
@@ -21,6 +24,118 @@ namespace pangea
      */
     using BuiltinFunction = std::function<Value(const std::vector<Value> &)>;
 
+    /**
+     * @brief Arguments passed to a builtin: a view of the caller's operand
+     * stack, valid only for the duration of the call
+     *
+     * The arguments are discarded once the call returns, so a builtin may
+     * move out of them; this lets it mutate an unshared collection in place
+     * instead of copying it.
+     */
+    using ValueSpan = std::span<Value>;
+
+    /**
+     * @brief Function signature for the allocation-free builtin fast path
+     *
+     * A plain function pointer plus an opaque context (typically the
+     * Interpreter), so calls involve neither std::function nor a copy of
+     * the arguments.
+     */
+    using FastFunction = Value (*)(void *context, ValueSpan args);
+
+    /**
+     * @brief An unevaluated argument of a special form: the words of one
+     * phrase, starting at word `start`
+     */
+    struct PhraseRef
+    {
+        int start;
+        int length;
+    };
+
+    /**
+     * @brief Arguments passed to a special form, valid for the duration of
+     * the call
+     */
+    using PhraseSpan = std::span<const PhraseRef>;
+
+    /**
+     * @brief Function signature for special forms
+     *
+     * A special form receives its argument phrases unevaluated and decides
+     * which of them to evaluate, and how often, through its context
+     * (typically the Interpreter).
+     */
+    using SpecialFunction = Value (*)(void *context, PhraseSpan args);
+
+    /**
+     * @brief Adapts a member function taking `const Value &` or `Value`
+     * parameters to the FastFunction calling convention
+     *
+     * The arity is taken from the member's signature. Parameters taken by
+     * value are moved out of the argument span. Members returning void
+     * yield a null Value.
+     *
+     * @example
+     * FastFunction fn = &MemberThunk<&Interpreter::plus>::call; // arity 2
+     */
+    template <auto Method>
+    struct MemberThunk;
+
+    template <typename Class, typename Result, typename... Params, Result (Class::*Method)(Params...)>
+    struct MemberThunk<Method>
+    {
+        static constexpr int arity = static_cast<int>(sizeof...(Params));
+
+        static Value call(void *context, ValueSpan args)
+        {
+            return apply(static_cast<Class *>(context), args, std::index_sequence_for<Params...>{});
+        }
+
+    private:
+        template <std::size_t... Index>
+        static Value apply(Class *self, ValueSpan args, std::index_sequence<Index...>)
+        {
+            if constexpr (std::is_void_v<Result>)
+            {
+                (self->*Method)(std::forward<Params>(args[Index])...);
+                return Value();
+            }
+            else
+            {
+                return (self->*Method)(std::forward<Params>(args[Index])...);
+            }
+        }
+    };
+
+    /**
+     * @brief Adapts a member function taking PhraseRef parameters to the
+     * SpecialFunction calling convention
+     *
+     * @example
+     * SpecialFunction fn = &SpecialFormThunk<&Interpreter::ifCondition>::call; // arity 3
+     */
+    template <auto Method>
+    struct SpecialFormThunk;
+
+    template <typename Class, typename... Params, Value (Class::*Method)(Params...)>
+    struct SpecialFormThunk<Method>
+    {
+        static constexpr int arity = static_cast<int>(sizeof...(Params));
+
+        static Value call(void *context, PhraseSpan args)
+        {
+            return apply(static_cast<Class *>(context), args, std::index_sequence_for<Params...>{});
+        }
+
+    private:
+        template <std::size_t... Index>
+        static Value apply(Class *self, PhraseSpan args, std::index_sequence<Index...>)
+        {
+            return (self->*Method)(args[Index]...);
+        }
+    };
+
     /**
      * @brief Represents a function entry in the namespace registry
      *
@@ -50,6 +165,9 @@ namespace pangea
         OperatorType operatorType_;
         NativeFunction function_;
         BuiltinFunction builtinFunction_; // For simplified builtin functions
+        FastFunction fastFunction_;       // Allocation-free builtin path
+        SpecialFunction specialFunction_; // Set for special forms
+        void *fastContext_;               // Passed back to fastFunction_ or specialFunction_
         std::vector<std::string> aliases_;
         int wordIndex_;                       // For user-defined functions
         std::shared_ptr<Value> boundContext_; // For future object method binding
@@ -64,6 +182,13 @@ namespace pangea
         FunctionEntry();
         FunctionEntry(int arity, OperatorType operatorType, NativeFunction function);
         FunctionEntry(const std::string &name, int arity, BuiltinFunction function); // For builtin functions
+        FunctionEntry(const std::string &name, int arity, FastFunction function, void *context); // For fast builtins
+        FunctionEntry(const std::string &name, int arity, SpecialFunction function, void *context); // For special forms
+
+        /**
+         * @brief Most argument phrases a special form may take
+         */
+        static constexpr int MaxSpecialArity = 8;
 
         // Copy and move constructors/operators
         FunctionEntry(const FunctionEntry &other) = default;
@@ -103,6 +228,13 @@ namespace pangea
         void setFunctionType(FunctionType functionType) { functionType_ = functionType; }
 
         bool getIsBuiltin() const { return isBuiltin_; }
+        bool hasFastPath() const { return fastFunction_ != nullptr; }
+        FastFunction getFastFunction() const { return fastFunction_; }
+
+        /**
+         * @brief Whether the function takes its arguments unevaluated
+         */
+        bool isSpecialForm() const { return specialFunction_ != nullptr; }
 
         // Utility methods
         int getEffectiveArity() const;
@@ -112,7 +244,8 @@ namespace pangea
 
         // Function call interface
         Value call(const std::vector<int> &params, Interpreter *interpreter) const;
-        Value invoke(const std::vector<Value> &args) const; // For builtin functions
+        Value invoke(ValueSpan args) const; // For builtin functions
+        Value invokeSpecial(PhraseSpan args) const; // For special forms
     };
 
 } // namespace pangea
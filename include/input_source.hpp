@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace pangea
+{
+
+    /**
+     * @brief Origin of line-oriented input, read through a reusable buffer
+     *
+     * Input is pulled in large chunks through fill() and split into lines
+     * in place, so a line costs a memchr and no per-line stream calls or
+     * allocations. The buffer grows only to hold a line longer than itself.
+     * Sources whose whole contents are already in memory, such as mapped
+     * files, skip the buffer and are split where they are.
+     */
+    class InputSource
+    {
+    public:
+        static constexpr std::size_t DefaultCapacity = 64 * 1024;
+
+        explicit InputSource(std::size_t capacity = DefaultCapacity);
+        InputSource(const InputSource &) = delete;
+        InputSource &operator=(const InputSource &) = delete;
+        virtual ~InputSource() = default;
+
+        /**
+         * @brief Lines of a file: mapped when it is a regular file, read
+         * through the buffer otherwise (pipes, terminals)
+         * @throws std::runtime_error if it cannot be opened
+         */
+        static std::unique_ptr<InputSource> open(const std::string &path);
+
+        /**
+         * @brief Read the next line, without its "\n" or "\r\n"
+         *
+         * The view points into the buffer and stays valid until the next
+         * call. A last line without a line break is still returned.
+         *
+         * @return false once the input is exhausted
+         */
+        bool readLine(std::string_view &line);
+
+    protected:
+        /**
+         * @brief Read up to `size` bytes into `buffer`, blocking until at
+         * least one is available
+         * @return The number of bytes read; 0 at the end of the input
+         */
+        virtual std::size_t fill(char *buffer, std::size_t size) = 0;
+
+        /**
+         * @brief Split `contents`, which must outlive the source, instead
+         * of calling fill()
+         */
+        void setContents(std::string_view contents);
+
+        /**
+         * @brief Told that the lines before `offset` of the contents have
+         * all been returned, about every ReleaseInterval bytes
+         */
+        virtual void consumed(std::size_t) {}
+
+        static constexpr std::size_t ReleaseInterval = 4 * 1024 * 1024;
+
+    private:
+        std::unique_ptr<char[]> storage_; // The buffer fill() writes to, null with setContents()
+        const char *data_;                // The buffer or the contents
+        std::size_t capacity_;
+        std::size_t begin_ = 0; // First byte not yet returned
+        std::size_t end_ = 0;   // End of the bytes read
+        bool exhausted_ = false;
+        std::size_t reported_ = 0; // Offset last passed to consumed()
+
+        std::string_view take(std::size_t length, std::size_t next);
+    };
+
+    /**
+     * @brief Source reading a file descriptor, by default standard input
+     *
+     * Reads go straight to the descriptor, so a line typed at a terminal
+     * is available as soon as it is entered. An owned descriptor is
+     * closed with the source.
+     */
+    class FileSource : public InputSource
+    {
+    public:
+        explicit FileSource(int descriptor = 0, std::size_t capacity = DefaultCapacity, bool owned = false)
+            : InputSource(capacity), descriptor_(descriptor), owned_(owned) {}
+        ~FileSource() override;
+
+    protected:
+        std::size_t fill(char *buffer, std::size_t size) override;
+
+    private:
+        int descriptor_;
+        bool owned_;
+    };
+
+    /**
+     * @brief Source reading a string held in memory
+     */
+    class StringSource : public InputSource
+    {
+    public:
+        explicit StringSource(std::string text, std::size_t capacity = DefaultCapacity)
+            : InputSource(capacity), text_(std::move(text)) {}
+
+    protected:
+        std::size_t fill(char *buffer, std::size_t size) override;
+
+    private:
+        std::string text_;
+        std::size_t position_ = 0;
+    };
+
+} // namespace pangea
@@ -3,9 +3,19 @@
 #include "value.hpp"
 #include "function_entry.hpp"
 #include "parser.hpp"
+#include "bytecode.hpp"
+#include "symbol_table.hpp"
+#include "object.hpp"
+#include "sequence.hpp"
+#include "output_sink.hpp"
+#include "input_source.hpp"
+#include "mapped_file.hpp"
 #include <vector>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <variant>
 #include <stack>
 #include <memory>
 #include <functional>
@@ -31,11 +41,14 @@ namespace pangea
     };
 
     /**
-     * @brief Stack frame for iteration contexts (each loops)
+     * @brief Stack frame for iteration contexts (times_loop and each)
+     *
+     * One frame per running loop, updated in place every iteration.
      */
     struct IterationFrame
     {
-        bool stop = false;
+        bool stop = false;   // Set by `stop`; ends the loop after the body
+        bool hasKey = false; // Iterating an object, whose key is `key`
         std::string key;
         Value value;
 
@@ -50,21 +63,119 @@ namespace pangea
      */
     class Interpreter
     {
+    public:
+        /**
+         * @brief How parsed programs are evaluated
+         *
+         * Bytecode compiles the phrase structure once and runs it on the
+         * stack VM; TreeWalk re-walks the words recursively and is kept as
+         * a reference implementation.
+         */
+        enum class ExecutionMode
+        {
+            Bytecode,
+            TreeWalk
+        };
+
+        /**
+         * @brief When print and println output reaches the destination
+         *
+         * Line passes it on after every println. Block waits until the
+         * sink's buffer is full or the top-level run ends, so a script
+         * printing many lines makes a few large writes. Explicit waits for
+         * a full buffer even across runs. The `flush` builtin, reading
+         * `input`, and destroying the interpreter flush under any policy.
+         */
+        enum class FlushPolicy
+        {
+            Line,
+            Block,
+            Explicit
+        };
+
+        /**
+         * @brief Buffer size of the default stdout sink
+         */
+        static constexpr std::size_t OutputBlockSize = 64 * 1024;
+
     private:
-        std::vector<std::string> words_;
+        /**
+         * @brief A function word still collecting arguments during phrase
+         * analysis, compilation or evaluation
+         */
+        struct OpenPhrase
+        {
+            int start;
+            int remaining;
+        };
+
+        /**
+         * @brief Inline cache of a get/set call site
+         *
+         * Remembers where the last object seen at the site kept the key, so
+         * objects of the same shape skip the lookup. The key is compared by
+         * identity, which holds for the literal key of a typical site. For
+         * set, `next` is the shape after appending a new key, if it was new.
+         */
+        struct PropertyCache
+        {
+            Value key;
+            std::shared_ptr<const Shape> shape;
+            std::shared_ptr<const Shape> next;
+            std::uint32_t slot = Object::NotFound;
+        };
+
+        std::deque<std::variant<std::string, MappedFile>> sources_; // Chunk buffers the words refer into
+        std::vector<Token> tokens_;
+        std::vector<std::string_view> words_; // Token text, viewing sources_
+        std::vector<SymbolId> wordSymbols_;   // Interned ID per word, None for literals
+        std::vector<std::uint32_t> wordConstants_; // Constant pool index per word, None for calls
+        std::vector<Value> constants_;        // Literals decoded once at parse time
+        std::vector<std::uint32_t> symbolConstants_; // Constant for each unbound identifier
         std::vector<int> phraseLengths_;
-        std::unordered_map<std::string, FunctionEntry> namespace_;
-        std::unordered_map<std::string, FunctionEntry> arities_;
+        std::vector<OpenPhrase> openPhrases_; // Innermost last
+        int executedUntil_ = 0;               // First top-level word not yet run
+        SymbolTable symbols_;
+        std::vector<std::unique_ptr<FunctionEntry>> functions_; // Indexed by SymbolId
         std::stack<StackFrame> callStack_;
-        std::stack<int> timesStack_;
-        std::stack<IterationFrame> eachStack_;
+        // One entry per running loop, innermost on top: its iteration index
+        // and its frame. Vectors keep their capacity between loops.
+        std::stack<std::size_t, std::vector<std::size_t>> timesStack_;
+        std::stack<IterationFrame, std::vector<IterationFrame>> eachStack_;
+        Bytecode bytecode_;
+        ExecutionMode executionMode_ = ExecutionMode::Bytecode;
+
+        // Evaluation state shared by both execution modes, reused across runs
+        std::vector<Value> operandStack_;
+        std::vector<OpenPhrase> pendingCalls_;
+        std::vector<PropertyCache> propertyCaches_; // Indexed by call site
+        int callSite_ = -1;                         // Word index of the running call
+        std::size_t maxDepth_ = DefaultMaxDepth;
+        std::size_t specialDepth_ = 0; // Special forms running inside one another
+
+        std::unique_ptr<OutputSink> output_; // Destination of print and println
+        std::shared_ptr<InputSource> input_; // Origin of input and lines, shared with their sequences
+        FlushPolicy flushPolicy_ = FlushPolicy::Block;
 
     public:
+        /**
+         * @brief Default limit on how many calls may wait for arguments at
+         * once, i.e. on phrase nesting depth
+         */
+        static constexpr std::size_t DefaultMaxDepth = 100000;
+
+        /**
+         * @brief Limit on special forms nested in each other's argument
+         * phrases, which, unlike other calls, nest on the C++ stack; the
+         * lower of this and the max depth applies
+         */
+        static constexpr std::size_t MaxSpecialFormDepth = 2000;
+
         // Constructor
         Interpreter();
 
-        // Destructor
-        ~Interpreter() = default;
+        // Destructor; flushes pending output
+        ~Interpreter();
 
         // Copy and move constructors (deleted - interpreter should be unique)
         Interpreter(const Interpreter &) = delete;
@@ -77,11 +188,91 @@ namespace pangea
          * @param code The source code to execute
          * @return The result of execution
          */
-        Value execute(const std::string &code);
+        Value execute(std::string code);
+
+        /**
+         * @brief Execute a script file, tokenizing its mapped pages in place
+         */
+        Value execute(MappedFile script);
+
+        /**
+         * @brief Append source code to the current program and run the
+         * top-level phrases it completes
+         *
+         * Only the appended words are analysed. A trailing phrase that is
+         * still missing arguments is kept pending until a later chunk
+         * completes it, so a program can be fed in arbitrary pieces.
+         *
+         * @param code The source code to append
+         * @return The result of the last phrase run, or null if none ran
+         */
+        Value executeChunk(std::string code);
+
+        /**
+         * @brief Whether a top-level phrase is waiting for more arguments
+         */
+        bool hasPendingPhrase() const { return !openPhrases_.empty(); }
+
+        /**
+         * @brief Discard the current program
+         */
+        void reset();
+
+        ExecutionMode getExecutionMode() const { return executionMode_; }
+        void setExecutionMode(ExecutionMode mode) { executionMode_ = mode; }
+
+        /**
+         * @brief Limit phrase nesting depth; deeper programs fail with a
+         * runtime_error instead of exhausting memory
+         */
+        std::size_t getMaxDepth() const { return maxDepth_; }
+        void setMaxDepth(std::size_t maxDepth) { maxDepth_ = maxDepth; }
+
+        /**
+         * @brief Sink that print and println write to; a FileSink on
+         * standard output with an OutputBlockSize buffer unless replaced
+         */
+        OutputSink &getOutput() { return *output_; }
+
+        /**
+         * @brief Send output to another sink, e.g. a StringSink when
+         * embedding or testing; the current sink is flushed first
+         */
+        void setOutput(std::unique_ptr<OutputSink> output);
+
+        FlushPolicy getFlushPolicy() const { return flushPolicy_; }
+        void setFlushPolicy(FlushPolicy policy) { flushPolicy_ = policy; }
+
+        /**
+         * @brief Pass buffered output on to its destination now
+         */
+        void flushOutput() { output_->flush(); }
+
+        /**
+         * @brief Source that input and lines read from; a FileSource on
+         * standard input unless replaced
+         */
+        InputSource &getInput() { return *input_; }
+
+        /**
+         * @brief Read input from another source, e.g. a StringSource when
+         * embedding or testing; sequences from earlier lines calls keep
+         * reading the previous one
+         */
+        void setInput(std::unique_ptr<InputSource> input) { input_ = std::move(input); }
 
         // Public accessors for testing
-        const std::vector<std::string> &getWords() const { return words_; }
-        const std::unordered_map<std::string, FunctionEntry> &getNamespace() const { return namespace_; }
+        const std::vector<std::string_view> &getWords() const { return words_; }
+        const std::vector<Token> &getTokens() const { return tokens_; }
+        const std::vector<int> &getPhraseLengths() const { return phraseLengths_; }
+        const SymbolTable &getSymbols() const { return symbols_; }
+        const Bytecode &getBytecode() const { return bytecode_; }
+
+        /**
+         * @brief Look up a function by name
+         * @return The function entry, or nullptr if the name is not bound
+         */
+        const FunctionEntry *findFunction(std::string_view name) const;
 
     private:
         /**
@@ -95,19 +286,80 @@ namespace pangea
         void registerBuiltin(const std::string &name, int arity, BuiltinFunction func);
 
         /**
-         * @brief Calculate phrase lengths for all words
+         * @brief Register a built-in function on the allocation-free path
          */
-        void calculatePhraseLengths();
+        void registerBuiltin(const std::string &name, int arity, FastFunction func, void *context = nullptr);
 
         /**
-         * @brief Calculate phrase length for parsing
-         * @param start Starting word index
-         * @return Length of the phrase
+         * @brief Register a member function as a builtin; its arity is the
+         * number of `const Value &` parameters it takes
+         */
+        template <auto Method>
+        void registerBuiltin(const std::string &name)
+        {
+            registerBuiltin(name, MemberThunk<Method>::arity, &MemberThunk<Method>::call, this);
+        }
+
+        /**
+         * @brief Register a member function taking PhraseRef parameters as a
+         * special form, which receives its arguments unevaluated
+         */
+        template <auto Method>
+        void registerSpecialForm(const std::string &name)
+        {
+            bindFunction(name, std::make_unique<FunctionEntry>(name, SpecialFormThunk<Method>::arity, &SpecialFormThunk<Method>::call, this));
+        }
+
+        /**
+         * @brief Bind a function entry to a name
          */
-        int phraseLength(int start);
+        void bindFunction(const std::string &name, std::unique_ptr<FunctionEntry> entry);
 
         /**
-         * @brief Execute a word/phrase range
+         * @brief Function bound to the word at an index, or nullptr
+         */
+        const FunctionEntry *functionAt(int index) const
+        {
+            SymbolId symbol = wordSymbols_[index];
+            return symbol < functions_.size() ? functions_[symbol].get() : nullptr;
+        }
+
+        /**
+         * @brief Tokenize a chunk of code and append its words
+         */
+        void appendSource(std::string code);
+        void appendSource(MappedFile script);
+
+        /**
+         * @brief Tokenize the chunk just added to sources_ and append its words
+         */
+        void loadSource(std::string_view source);
+
+        /**
+         * @brief Run the not yet executed top-level phrases before a word
+         * @param end Word index to stop at
+         * @return Result of the last phrase run, or null if none ran
+         */
+        Value runPhrases(int end);
+
+        /**
+         * @brief Append words for tokens of a source chunk, interning
+         * identifiers and decoding literals into the constant pool
+         */
+        void loadWords(const std::vector<Token> &tokens, std::string_view source);
+
+        /**
+         * @brief Calculate phrase lengths for words appended from an index
+         *
+         * Linear in the number of new words; phrases left open by earlier
+         * calls are resumed rather than recomputed.
+         *
+         * @param from First word not analysed yet
+         */
+        void calculatePhraseLengths(int from);
+
+        /**
+         * @brief Execute a word/phrase range without recursion
          * @param start Starting word index
          * @param end Ending word index
          * @return Result of execution
@@ -115,42 +367,176 @@ namespace pangea
         Value wordExec(int start, int end);
 
         /**
-         * @brief Parse a literal value from a string
-         * @param word The word to parse
-         * @return Parsed value
+         * @brief Compile the top-level phrases in a word range into bytecode_
+         * @param from First word of the first phrase
+         * @param to Word index to stop at
+         */
+        void compile(int from, int to);
+
+        /**
+         * @brief Call a function with its arguments taken from the top of
+         * the operand stack, which are popped
+         * @param entry The function to call
+         * @param argc Number of arguments on the stack
+         * @param site Word index of the call, keying its inline caches
+         * @return The function's result
+         */
+        Value callWithStackArgs(const FunctionEntry &entry, int argc, int site);
+
+        /**
+         * @brief Call a special form on the argument phrases following its
+         * word, without evaluating them
+         * @param entry The special form
+         * @param site Word index of the call
+         * @return The special form's result
+         */
+        Value callSpecialForm(const FunctionEntry &entry, int site);
+
+        /**
+         * @brief Evaluate an argument phrase of a running special form
+         *
+         * Runs the phrase's compiled block in Bytecode mode and walks its
+         * words otherwise; neither parses again or allocates once the
+         * operand stack has grown to the phrase's depth.
+         */
+        Value evaluate(const PhraseRef &phrase);
+
+        /**
+         * @brief Run bytecode_ on the stack VM
+         * @return Value left by the last top-level phrase
+         */
+        Value runBytecode();
+
+        /**
+         * @brief Run a range of instructions on the stack VM
+         * @return Value left on the stack, or null if none
          */
-        Value parseLiteral(const std::string &word);
+        Value runBytecode(const Instruction *first, const Instruction *last);
 
         // Built-in function implementations
-        Value plus(const Value &a, const Value &b);
-        Value minus(const Value &a, const Value &b);
-        Value times(const Value &a, const Value &b);
-        Value divide(const Value &a, const Value &b);
-        Value power(const Value &a, const Value &b);
+        Value plus(Value a, Value b);
+        Value minus(Value a, Value b);
+        Value times(Value a, Value b);
+        Value divide(Value a, Value b);
+        Value power(Value a, Value b);
 
         Value equal(const Value &a, const Value &b);
-        Value less(const Value &a, const Value &b);
-        Value greater(const Value &a, const Value &b);
+        Value less(Value a, Value b);
+        Value greater(Value a, Value b);
 
-        Value logicalAnd(const Value &a, const Value &b);
-        Value logicalOr(const Value &a, const Value &b);
+        // Special forms: their arguments are phrases evaluated on demand
+        Value logicalAnd(PhraseRef a, PhraseRef b);
+        Value logicalOr(PhraseRef a, PhraseRef b);
         Value logicalNot(const Value &a);
 
         void print(const Value &value);
         void println(const Value &value);
         Value input();
+        Value lines();
 
-        Value ifCondition(const Value &condition, const Value &thenValue, const Value &elseValue);
-        Value timesLoop(const Value &count, const Value &body);
-        Value each(const Value &collection, const Value &body);
+        /**
+         * @brief Files: read_file copies a file's contents into a string,
+         * file_lines streams its lines like lines, and file_size reads its
+         * size without opening it
+         */
+        Value readFile(const Value &path);
+        Value fileLines(const Value &path);
+        Value fileSize(const Value &path);
+
+        /**
+         * @brief Delimited files as an object of columns (see CsvReader):
+         * read_csv splits on commas, read_tsv on tabs
+         */
+        Value readCsv(const Value &path);
+        Value readTsv(const Value &path);
+
+        Value ifCondition(PhraseRef condition, PhraseRef thenBranch, PhraseRef elseBranch);
+        Value timesLoop(PhraseRef count, PhraseRef body);
+        Value each(PhraseRef collection, PhraseRef body);
+
+        /**
+         * @brief Run a loop body once per item produced by `next`, which
+         * fills in the frame and returns false when the items run out
+         *
+         * Pushes the loop's timesStack_ entry and frame for the duration
+         * and stops early once the body calls `stop`.
+         */
+        template <typename Next>
+        Value runLoop(PhraseRef body, Next &&next);
+
+        /**
+         * @brief Innermost loop's frame; throws outside of a loop
+         */
+        IterationFrame &currentLoop(const char *name);
+
+        // Loop variables and control, for the innermost running loop
+        Value loopIndex();
+        Value loopKey();
+        Value loopValue();
+        void stopLoop();
 
         Value length(const Value &value);
         Value type(const Value &value);
-        Value toString(const Value &value);
+        Value toString(Value value);
+        Value join(const Value &collection, const Value &separator);
         Value toNumber(const Value &value);
 
-        Value get(const Value &collection, const Value &key);
-        Value set(const Value &collection, const Value &key, const Value &value);
+        /**
+         * @brief Reductions over the numbers of an array or sequence
+         *
+         * Packed arrays run the VectorMath kernels on their buffer; boxed
+         * arrays and sequences are fed to them in fixed-size blocks. min,
+         * max, mean and argmax of an empty input are null.
+         */
+        Value sum(const Value &collection);
+        Value minimum(const Value &collection);
+        Value maximum(const Value &collection);
+        Value mean(const Value &collection);
+        Value countIf(const Value &collection);
+        Value dot(const Value &a, const Value &b);
+        Value argmax(const Value &collection);
+
+        /**
+         * @brief The builtin bound to a name, for map and filter
+         */
+        const FunctionEntry &functionNamed(const Value &name);
+
+        Value range(const Value &start, const Value &end);
+        Value map(const Value &collection, const Value &function, Value operand);
+        Value filter(const Value &collection, const Value &function, Value operand);
+        Value take(const Value &collection, const Value &count);
+        Value zip(const Value &first, const Value &second);
+
+        /**
+         * @brief Inline cache of the running call site, or nullptr
+         */
+        PropertyCache *propertyCache();
+
+        /**
+         * @brief Slot of a key in an object, through the site's inline cache
+         */
+        std::uint32_t findProperty(const Object &object, const Value &key);
+
+        /**
+         * @brief Store a value under a key, through the site's inline cache
+         */
+        void storeProperty(Object &object, const Value &key, Value value);
+
+        Value get(Value collection, const Value &key);
+        Value set(Value collection, const Value &key, Value value);
+
+        /**
+         * @brief Tables (see Table): table makes one of an object of
+         * columns, select keeps some of its columns, group_by groups its
+         * rows and aggregate reduces the groups
+         *
+         * filter on a table takes an object of column conditions, and get
+         * reads a column by name or a row by index.
+         */
+        Value toTable(const Value &columns);
+        Value select(const Value &table, const Value &names);
+        Value groupBy(const Value &table, const Value &column);
+        Value aggregate(const Value &table, const Value &spec);
     };
 
 } // namespace pangea
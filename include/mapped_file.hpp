@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace pangea
+{
+
+    /**
+     * @brief Read-only contents of a file, memory-mapped when possible
+     *
+     * Regular files are mapped, so their bytes are read straight from the
+     * page cache without being copied, and pages are only brought in as
+     * they are touched. Files that cannot be mapped (pipes, terminals,
+     * empty files, or any file on platforms without mmap) are read into
+     * memory instead. Either way text() views the whole contents until
+     * this MappedFile is destroyed or moved from.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief Open and map (or read) a file
+         * @throws std::runtime_error if it cannot be opened or read
+         */
+        explicit MappedFile(const std::string &path);
+
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        ~MappedFile();
+
+        std::string_view text() const { return mapping_ ? std::string_view(mapping_, size_) : std::string_view(contents_); }
+        bool isMapped() const { return mapping_ != nullptr; }
+
+        /**
+         * @brief Let the kernel drop the mapped pages before `offset`
+         *
+         * For reading a large file front to back without its pages
+         * accumulating in memory; touching them again reads them back from
+         * the file. Does nothing for contents read into memory.
+         */
+        void release(std::size_t offset);
+
+        /**
+         * @brief Whether a file can be mapped, i.e. is a non-empty regular file
+         * @throws std::runtime_error if it does not exist
+         */
+        static bool isMappable(const std::string &path);
+
+        /**
+         * @brief Size of a regular file in bytes, without reading it
+         * @throws std::runtime_error if it does not exist or has no size,
+         * such as a pipe
+         */
+        static std::uint64_t sizeOf(const std::string &path);
+
+    private:
+        const char *mapping_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t released_ = 0; // Page-aligned prefix already released
+        std::string contents_;     // When not mapped
+
+        void unmap();
+    };
+
+} // namespace pangea
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "value.hpp"
+#include "flat_map.hpp"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pangea
+{
+
+    /**
+     * @brief Hash for string-keyed maps that can be probed with a
+     * std::string_view without building a std::string
+     */
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    template <typename T>
+    using StringMap = std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
+
+    /**
+     * @brief Layout shared by objects that gained the same keys in the same
+     * order (a "hidden class")
+     *
+     * A shape maps each key to the index of its slot in the object's value
+     * array. Shapes form a transition tree rooted at the empty shape: adding
+     * a key to an object moves it to the child shape for that key, which is
+     * created once and reused by every object taking the same path. Shapes
+     * are immutable once created, so a shape pointer identifies a layout.
+     *
+     * A child holds its parent, but a parent only observes its children:
+     * a shape lives while an object (or a cache) uses it or one of its
+     * descendants, and a freed shape leaves its parent's transitions. A
+     * child shares its parent's key storage, appending its key in place
+     * when it is the first to extend it, so a path of k keys stores each
+     * key once instead of copying every prefix.
+     */
+    class Shape : public std::enable_shared_from_this<Shape>
+    {
+    public:
+        static constexpr std::uint32_t NotFound = UINT32_MAX;
+
+        /**
+         * @brief The shape of an object without keys
+         */
+        static const std::shared_ptr<const Shape> &empty();
+
+        ~Shape();
+
+        std::size_t size() const { return size_; }
+        const std::string &keyAt(std::uint32_t slot) const { return (*keys_)[slot]; }
+
+        /**
+         * @brief Slot holding a key, or NotFound
+         */
+        std::uint32_t find(std::string_view key) const;
+
+        /**
+         * @brief The shape reached by appending a key to this one
+         */
+        std::shared_ptr<const Shape> withKey(std::string_view key) const;
+
+        /**
+         * @brief Number of shapes reachable by appending one key
+         */
+        std::size_t transitionCount() const { return transitions_.size(); }
+
+    private:
+        // In slot order; the first size_ keys are this shape's, the rest
+        // belong to descendants sharing the storage
+        std::shared_ptr<std::deque<std::string>> keys_;
+        std::size_t size_ = 0;
+        std::shared_ptr<const Shape> parent_;
+        mutable StringMap<std::weak_ptr<const Shape>> transitions_;
+    };
+
+    /**
+     * @brief Storage behind Value::Type::Object
+     *
+     * Keys are kept in insertion order. Small objects keep their values in a
+     * flat slot array described by a shared Shape, so objects built alike
+     * share one key table and a (shape, slot) pair found once can be reused
+     * for every object of that shape. Objects that grow past MaxShapeSize
+     * keys switch to dictionary mode, backed by a FlatMap of their own.
+     */
+    class Object
+    {
+    public:
+        static constexpr std::uint32_t NotFound = Shape::NotFound;
+
+        /**
+         * @brief Largest object kept in shape mode
+         */
+        static constexpr std::size_t MaxShapeSize = 64;
+
+        Object() : shape_(Shape::empty()) {}
+
+        std::size_t size() const { return shape_ ? slots_.size() : dictionary_.size(); }
+        bool empty() const { return size() == 0; }
+
+        /**
+         * @brief Shape of the object, or nullptr in dictionary mode
+         */
+        const std::shared_ptr<const Shape> &getShape() const { return shape_; }
+
+        // Entries by slot, in insertion order
+        const std::string &keyAt(std::uint32_t slot) const { return shape_ ? shape_->keyAt(slot) : dictionary_.keyAt(slot); }
+        const Value &valueAt(std::uint32_t slot) const { return shape_ ? slots_[slot] : dictionary_.valueAt(slot); }
+        Value &valueAt(std::uint32_t slot) { return shape_ ? slots_[slot] : dictionary_.valueAt(slot); }
+
+        /**
+         * @brief Slot holding a key, or NotFound
+         */
+        std::uint32_t findSlot(std::string_view key) const;
+
+        /**
+         * @brief Value stored under a key, or nullptr
+         */
+        const Value *find(std::string_view key) const;
+
+        /**
+         * @brief Store a value under a key, appending the key if it is new
+         * @return The key's slot
+         */
+        std::uint32_t set(std::string_view key, Value value);
+
+        /**
+         * @brief Append a value for a key known to be absent, moving to a
+         * shape previously obtained with getShape()->withKey(key)
+         *
+         * Lets a cached transition skip the key lookup; the object must
+         * still be in the shape the transition starts from.
+         */
+        void append(std::shared_ptr<const Shape> shape, Value value);
+
+        /**
+         * @brief Equal when both hold the same keys with equal values,
+         * regardless of order
+         */
+        bool operator==(const Object &other) const;
+        bool operator!=(const Object &other) const { return !(*this == other); }
+
+    private:
+        std::shared_ptr<const Shape> shape_; // Null in dictionary mode
+        std::vector<Value> slots_;           // Shape mode only
+        FlatMap<Value> dictionary_;          // Dictionary mode only
+
+        void toDictionary();
+    };
+
+} // namespace pangea
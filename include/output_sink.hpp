@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace pangea
+{
+
+    /**
+     * @brief Destination for serialized text, with a fixed write buffer
+     *
+     * Writers append small pieces into a buffer allocated once; only when
+     * it fills up are the buffered bytes handed to the destination through
+     * consume(). Serializing a large value therefore needs the buffer and
+     * nothing else, however long its text is, and a large buffer turns
+     * many small writes into a few large ones.
+     *
+     * Derived sinks must call drain() in their destructor, since consume()
+     * can no longer be dispatched to them from this one.
+     */
+    class OutputSink
+    {
+    public:
+        static constexpr std::size_t DefaultCapacity = 4096;
+
+        explicit OutputSink(std::size_t capacity = DefaultCapacity)
+            : capacity_(capacity > 0 ? capacity : 1), buffer_(std::make_unique_for_overwrite<char[]>(capacity_)) {}
+        OutputSink(const OutputSink &) = delete;
+        OutputSink &operator=(const OutputSink &) = delete;
+        virtual ~OutputSink() = default;
+
+        void write(std::string_view text)
+        {
+            if (text.size() > capacity_ - used_)
+            {
+                writeSlow(text);
+                return;
+            }
+            std::memcpy(buffer_.get() + used_, text.data(), text.size());
+            used_ += text.size();
+        }
+
+        void put(char c)
+        {
+            if (used_ == capacity_)
+            {
+                drain();
+            }
+            buffer_[used_++] = c;
+        }
+
+        /**
+         * @brief Pass everything written so far on to the destination
+         */
+        virtual void flush() { drain(); }
+
+    protected:
+        /**
+         * @brief Hand the buffered bytes to consume() and empty the buffer
+         */
+        void drain()
+        {
+            if (used_ > 0)
+            {
+                consume(std::string_view(buffer_.get(), used_));
+                used_ = 0;
+            }
+        }
+
+        virtual void consume(std::string_view bytes) = 0;
+
+    private:
+        std::size_t capacity_;
+        std::size_t used_ = 0;
+        std::unique_ptr<char[]> buffer_;
+
+        void writeSlow(std::string_view text);
+    };
+
+    /**
+     * @brief Sink writing to a std::ostream; flush() flushes the stream too
+     */
+    class StreamSink : public OutputSink
+    {
+    public:
+        explicit StreamSink(std::ostream &stream, std::size_t capacity = DefaultCapacity)
+            : OutputSink(capacity), stream_(stream) {}
+        ~StreamSink() override { drain(); }
+
+        void flush() override
+        {
+            drain();
+            stream_.flush();
+        }
+
+    protected:
+        void consume(std::string_view bytes) override { stream_.write(bytes.data(), static_cast<std::streamsize>(bytes.size())); }
+
+    private:
+        std::ostream &stream_;
+    };
+
+    /**
+     * @brief Sink writing to a file descriptor, by default standard output
+     *
+     * Each block goes straight to the descriptor with one write() call
+     * (more if the descriptor takes part of it), bypassing iostreams. On
+     * standard output, std::cout is flushed before each block, so text
+     * written through it first still comes out first. An owned descriptor
+     * is closed with the sink.
+     */
+    class FileSink : public OutputSink
+    {
+    public:
+        explicit FileSink(int descriptor = 1, std::size_t capacity = DefaultCapacity, bool owned = false)
+            : OutputSink(capacity), descriptor_(descriptor), owned_(owned) {}
+        ~FileSink() override;
+
+    protected:
+        /**
+         * @throws std::runtime_error if the descriptor cannot be written
+         */
+        void consume(std::string_view bytes) override;
+
+    private:
+        int descriptor_;
+        bool owned_;
+    };
+
+    /**
+     * @brief Sink collecting its text in memory
+     */
+    class StringSink : public OutputSink
+    {
+    public:
+        ~StringSink() override { drain(); }
+
+        /**
+         * @brief Everything written so far
+         */
+        std::string &str()
+        {
+            drain();
+            return text_;
+        }
+
+    protected:
+        void consume(std::string_view bytes) override { text_.append(bytes); }
+
+    private:
+        std::string text_;
+    };
+
+} // namespace pangea
@@ -1,12 +1,32 @@
 #pragma once
 
 #include "value.hpp"
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace pangea
 {
 
+    /**
+     * @brief A token located in a source buffer
+     *
+     * Tokens do not own their text: they record where it sits in the
+     * buffer they were produced from, plus the 1-based line and column
+     * of their first character for diagnostics.
+     */
+    struct Token
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint32_t line;
+        std::uint32_t column;
+
+        std::string_view text(std::string_view source) const { return source.substr(offset, length); }
+    };
+
     /**
      * @brief Parser for Pangea source code
      *
@@ -23,10 +43,8 @@ namespace pangea
         /**
          * @brief Parse Pangea source code into tokens
          *
-         * Complete parsing pipeline that:
-         * 1. Removes comments (preserving # in function arity notation)
-         * 2. Tokenizes while preserving quoted string literals
-         * 3. Returns clean token vector for interpreter consumption
+         * Convenience wrapper over tokenize() that copies each token's
+         * text into its own string.
          *
          * @param code The source code to parse
          * @return Vector of tokens ready for interpretation
@@ -41,25 +59,45 @@ namespace pangea
         static std::vector<std::string> parseCode(const std::string &code);
 
         /**
-         * @brief Parse a token into a Value (number, string, boolean, null)
-         *
-         * Converts string tokens into typed Value objects:
-         * - Numbers: "123" -> Value(123.0), "3.14" -> Value(3.14)
+         * @brief Decode a literal token (number, string, boolean, null)
+         *
+         * The single set of literal rules shared by the parser and the
+         * interpreter; runs once per token when source is parsed.
+         * - Numbers: a digit, or a sign and/or '.' followed by a digit,
+         *   decoded with std::from_chars; the whole token must match.
+         *   Whole numbers without '.' or exponent that fit are inline
+         *   integers, except "-0", which stays a double
          * - Strings: "\"hello\"" -> Value("hello") (quotes removed)
          * - Booleans: "true" -> Value(true), "false" -> Value(false)
-         * - Null: "null" -> Value() (null value)
-         * - Others: Returns null Value for non-literals
+         * - Null: "null" -> Value()
+         *
+         * @param text The token to decode
+         * @return The literal value, or std::nullopt for identifiers
+         *
+         * @example
+         * decodeLiteral("42")       // -> Value(std::int64_t(42)), an inline integer
+         * decodeLiteral("-0")       // -> Value(-0.0), a double
+         * decodeLiteral("-.5")      // -> Value(-0.5)
+         * decodeLiteral("3abc")     // -> std::nullopt (identifier)
+         */
+        static std::optional<Value> decodeLiteral(std::string_view text);
+
+        /**
+         * @brief Parse a token into a Value (number, string, boolean, null)
+         *
+         * Same rules as decodeLiteral(), with non-literals mapped to a
+         * null Value.
          *
          * @param text The token to parse
          * @return Parsed Value or null Value if not a literal
          *
          * @example
-         * parseValue("42")       // -> Value(42.0)
+         * parseValue("42")       // -> Value(std::int64_t(42)), an inline integer
          * parseValue("\"text\"") // -> Value("text")
          * parseValue("true")     // -> Value(true)
          * parseValue("variable") // -> Value() (null, not a literal)
          */
-        static Value parseValue(const std::string &text);
+        static Value parseValue(std::string_view text);
 
         /**
          * @brief Check if a token is a string literal
@@ -78,88 +116,40 @@ namespace pangea
          * isString("hello")       // -> false
          * isString("\"incomplete") // -> false
          */
-        static bool isString(const std::string &text);
+        static bool isString(std::string_view text);
 
-    private:
         /**
-         * @brief Tokenize code while preserving quoted strings
+         * @brief Split source code into tokens in a single pass
          *
-         * Core tokenization algorithm that handles:
+         * Comments, string literals and whitespace are handled together
+         * while scanning the buffer once; no token text is copied.
          *
-         * **String Preservation Logic:**
-         * - Tracks quote state with `inQuotes` flag
-         * - Preserves all characters (including spaces) within quotes
-         * - Maintains quotes as part of the token for later processing
+         * **Comments:**
+         * - `#` preceded by whitespace (or at the start of the source)
+         *   starts a comment that runs to the end of the line
+         * - `#` preceded by any other character is part of the word, so
+         *   function arity notation such as `add#2` is preserved
          *
-         * **Whitespace Handling:**
-         * - Uses std::isspace() to identify delimiters outside quotes
-         * - Treats spaces, tabs, newlines as token separators
-         * - Ignores whitespace inside quoted strings
+         * **String Literals:**
+         * - A double quote starts a string token that runs to the next
+         *   unescaped double quote, keeping both quotes in the token
+         * - Whitespace and `#` inside a string are ordinary characters
+         * - A backslash escapes the character after it, so `\"` does not
+         *   terminate the string
+         * - Unterminated strings are reported on std::cerr and kept as
+         *   a token running to the end of the source
          *
-         * **Error Handling:**
-         * - Detects unterminated string literals
-         * - Outputs warning to std::cerr for missing closing quotes
-         * - Gracefully continues parsing despite errors
+         * **Whitespace:**
+         * - Spaces, tabs and line breaks separate tokens outside strings
          *
-         * **Token Building:**
-         * - Accumulates characters in currentToken buffer
-         * - Flushes complete tokens to result vector
-         * - Handles empty tokens and edge cases
-         *
-         * @param code The code to tokenize
-         * @return Vector of tokens with preserved string literals
-         *
-         * @example
-         * tokenizeWithStringPreservation("hello \"world of code\" test")
-         * // Returns: ["hello", "\"world of code\"", "test"]
-         *
-         * tokenizeWithStringPreservation("func \"unterminated)
-         * // Outputs: "Error: Unterminated string literal"
-         * // Returns: ["func", "\"unterminated"]
-         */
-        static std::vector<std::string> tokenizeWithStringPreservation(const std::string &code);
-
-        /**
-         * @brief Remove comments from a line while preserving # in function names
-         *
-         * Sophisticated comment removal that distinguishes between:
-         *
-         * **Function Arity Notation (Preserved):**
-         * - Pattern: `functionName#number` (e.g., "add#2", "map#3")
-         * - Detection: # preceded by non-whitespace character
-         * - Behavior: Preserves the # as part of function identifier
-         *
-         * **Line Comments (Removed):**
-         * - Pattern: `# comment text` (# preceded by whitespace or start of line)
-         * - Behavior: Truncates line at comment start
-         *
-         * **String Context Awareness:**
-         * - Tracks string literal boundaries with quote state
-         * - Ignores # characters inside quoted strings
-         * - Handles escape sequences within strings
-         *
-         * **Escape Sequence Handling:**
-         * - Recognizes backslash escapes (\")
-         * - Prevents escaped quotes from terminating strings
-         * - Preserves escape sequences in output
-         *
-         * @param line The line to process
-         * @return Line with comments removed, function notation preserved
+         * @param source The source code to tokenize
+         * @return Tokens referring into source, in source order
          *
          * @example
-         * removeComments("add#2 5 3 # calculate sum")
-         * // Returns: "add#2 5 3 "
-         *
-         * removeComments("print \"text with # symbol\" # comment")
-         * // Returns: "print \"text with # symbol\" "
-         *
-         * removeComments("# full line comment")
-         * // Returns: ""
-         *
-         * removeComments("escaped \" # inside string \"")
-         * // Returns: "escaped \" # inside string \""
+         * tokenize("print \"a # b\" # comment")
+         * // Returns tokens for: ["print", "\"a # b\""]
          */
-        static std::string removeComments(const std::string &line);
+        static std::vector<Token> tokenize(std::string_view source);
     };
 
 } // namespace pangea
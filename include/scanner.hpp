@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pangea
+{
+
+    /**
+     * @brief Vectorized byte scanning used by the tokenizer and the CSV
+     * reader
+     *
+     * Each scan starts at `pos` and returns the index of the first byte
+     * that stops it, or `size` if none does. The SSE2 and AVX2 backends
+     * test 16 or 32 bytes per step; the scalar backend is the reference
+     * and the fallback on other targets. The best supported backend is
+     * picked at runtime on first use.
+     *
+     * The `#` comment rule needs no vector support: a `#` only starts a
+     * comment right after whitespace, which is always where the tokenizer
+     * is about to start a new token, so it is checked there in scalar code.
+     */
+    class Scanner
+    {
+    public:
+        enum class Backend
+        {
+            Scalar,
+            SSE2,
+            AVX2
+        };
+
+        /**
+         * @brief Skip spaces, tabs, carriage returns, vertical tabs and
+         * form feeds; stops at line feeds so lines can be counted
+         */
+        static std::size_t skipBlanks(const char *data, std::size_t pos, std::size_t size);
+
+        /**
+         * @brief Find the end of a bare word: whitespace, a double quote
+         * or a backslash
+         */
+        static std::size_t findWordEnd(const char *data, std::size_t pos, std::size_t size);
+
+        /**
+         * @brief Find the next byte of interest inside a string literal:
+         * a double quote, a backslash or a line feed
+         */
+        static std::size_t findStringEnd(const char *data, std::size_t pos, std::size_t size);
+
+        static constexpr std::size_t FieldBlockSize = 64;
+
+        /**
+         * @brief Positions in a block of FieldBlockSize bytes that end an
+         * unquoted CSV field: bit i is set when block[i] is `delimiter`, a
+         * double quote or a line feed
+         *
+         * CSV fields are mostly a few bytes long, so a reader classifies
+         * each block once and walks the bits, rather than starting a scan
+         * per field.
+         */
+        static std::uint64_t fieldStops(const char *block, char delimiter);
+
+        /**
+         * @brief Find the next line feed (end of a comment)
+         */
+        static std::size_t findLineEnd(const char *data, std::size_t pos, std::size_t size);
+
+        static Backend getBackend();
+        static void setBackend(Backend backend);
+        static bool isSupported(Backend backend);
+        static Backend getBestBackend();
+        static std::string getBackendName(Backend backend);
+    };
+
+} // namespace pangea
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "value.hpp"
+#include "input_source.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pangea
+{
+
+    /**
+     * @brief Storage behind Value::Type::Sequence: a lazy stream of values
+     *
+     * A sequence is a chain of stages (range, array, lines, map, filter,
+     * take, zip) that produces its elements only when a Cursor pulls them. Each
+     * element travels through the whole chain before the next one is
+     * produced, so consuming `filter map range ...` runs in one pass and
+     * never builds an intermediate array. Stages are immutable and shared,
+     * so copying a sequence or extending it with another stage is O(1).
+     *
+     * Map and filter stages call a FunctionEntry, which must outlive the
+     * sequence; builtins live as long as their Interpreter.
+     */
+    class Sequence
+    {
+        struct Node; // A stage, defined in sequence.cpp
+
+    public:
+        static constexpr std::size_t Unknown = SIZE_MAX;
+
+        /**
+         * @brief start, start + 1, ... while below end
+         */
+        static Sequence range(double start, double end);
+
+        /**
+         * @brief The elements of an array, or a sequence unchanged
+         */
+        static Sequence of(const Value &collection);
+
+        /**
+         * @brief The lines read from a source, ending with its input
+         *
+         * Lines are consumed as they are pulled, so another pass continues
+         * where the previous one stopped. Each line overwrites the string
+         * of the one before unless that string is still referenced.
+         */
+        static Sequence lines(std::shared_ptr<InputSource> source);
+
+        /**
+         * @brief The lines of a file, read like lines(); every pass opens
+         * the file again (see InputSource::open) and starts from its top
+         */
+        static Sequence fileLines(std::string path);
+
+        /**
+         * @brief Pairs [a, b] of corresponding elements, as long as the
+         * shorter input
+         */
+        static Sequence zip(const Sequence &first, const Sequence &second);
+
+        /**
+         * @brief Elements passed through a one- or two-argument function,
+         * with `operand` as the second argument
+         */
+        Sequence map(const FunctionEntry &function, Value operand) const;
+
+        /**
+         * @brief Elements for which the function (called as in map) returns
+         * a truthy value
+         */
+        Sequence filter(const FunctionEntry &function, Value operand) const;
+
+        /**
+         * @brief At most the first `count` elements
+         */
+        Sequence take(std::size_t count) const;
+
+        /**
+         * @brief Number of elements without iterating, or Unknown when a
+         * filter or lines stage decides it
+         */
+        std::size_t knownSize() const;
+
+        /**
+         * @brief Number of elements, iterating only when knownSize() is
+         * Unknown
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Sequences are equal only when they are the same chain
+         */
+        bool operator==(const Sequence &other) const { return node_ == other.node_; }
+
+        /**
+         * @brief One pass over a sequence
+         *
+         * Holds one small state per stage, allocated when the cursor is
+         * created; pulling elements allocates nothing beyond what the
+         * stages' functions (and zip's pairs) do.
+         */
+        class Cursor
+        {
+        public:
+            explicit Cursor(const Sequence &sequence);
+
+            /**
+             * @brief Store the next element in `out`
+             * @return false once the sequence is exhausted
+             */
+            bool next(Value &out) { return pull(0, out); }
+
+        private:
+            struct State
+            {
+                const Node *node;
+                std::size_t position = 0;            // Elements produced (range, array, take)
+                std::uint32_t input = 0;             // State of the first input
+                std::uint32_t second = 0;            // State of zip's second input
+                std::unique_ptr<InputSource> file{}; // This pass's file (file lines)
+            };
+
+            std::shared_ptr<const Node> root_; // Keeps the stages alive
+            std::vector<State> states_;                   // Depth-first, the last stage first
+
+            std::uint32_t addState(const Node *node);
+            bool pull(std::uint32_t index, Value &out);
+        };
+
+    private:
+        std::shared_ptr<const Node> node_;
+
+        explicit Sequence(std::shared_ptr<const Node> node) : node_(std::move(node)) {}
+    };
+
+} // namespace pangea
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace pangea
+{
+
+    using SymbolId = std::uint32_t;
+
+    /**
+     * @brief Interns identifiers into dense integer IDs
+     *
+     * Each distinct name is stored once and numbered in order of first
+     * appearance, so tables indexed by SymbolId can be plain vectors.
+     * Names live in a deque, which keeps them at stable addresses for the
+     * string_view keys of the lookup map.
+     */
+    class SymbolTable
+    {
+    public:
+        static constexpr SymbolId None = UINT32_MAX;
+
+        /**
+         * @brief Return the ID of a name, adding it if it is new
+         */
+        SymbolId intern(std::string_view name);
+
+        /**
+         * @brief Return the ID of a name, or None if it was never interned
+         */
+        SymbolId find(std::string_view name) const;
+
+        const std::string &getName(SymbolId id) const { return names_[id]; }
+        std::size_t size() const { return names_.size(); }
+
+    private:
+        std::deque<std::string> names_;
+        std::unordered_map<std::string_view, SymbolId> ids_;
+    };
+
+} // namespace pangea
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "value.hpp"
+#include "vector_math.hpp"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pangea
+{
+
+    /**
+     * @brief Storage behind Value::Type::Table: named columns of equal
+     * length, seen through a selection vector
+     *
+     * Columns are arrays, typically the packed number arrays and string
+     * columns read_csv builds, and every table derived from another shares
+     * them. A filter copies no rows either: it produces a selection vector,
+     * the increasing positions of the rows kept, and a column is gathered
+     * only when it is asked for. Comparisons of packed number columns run
+     * a block at a time through VectorMath::select, and comparisons of
+     * string columns on their bytes in place, so neither calls a function
+     * per row.
+     *
+     * group_by assigns every selected row the index of its group once;
+     * aggregate then reduces each column into per-group accumulators in a
+     * single pass over its rows.
+     */
+    class Table
+    {
+    public:
+        static constexpr std::uint32_t NotFound = UINT32_MAX;
+
+        /**
+         * @brief A table of the arrays of an object, named by its keys
+         * @throws std::runtime_error if a value is not an array or the
+         * arrays differ in length
+         */
+        static Table fromColumns(const Object &columns);
+
+        std::size_t rowCount() const { return selection_ ? selection_->size() : rows_; }
+        std::size_t columnCount() const { return names_.size(); }
+        const std::string &nameAt(std::size_t index) const { return names_[index]; }
+
+        /**
+         * @brief Index of the column called `name`, or NotFound
+         */
+        std::uint32_t findColumn(std::string_view name) const;
+
+        /**
+         * @brief The selected rows of a column, as an array of the
+         * column's layout; the column itself when every row is selected
+         */
+        Value column(std::size_t index) const;
+
+        /**
+         * @brief One row as an object of its fields
+         */
+        Value row(std::size_t index) const;
+
+        /**
+         * @brief Rows for which `function(field, operand)` is truthy for
+         * every column and operand of `conditions`
+         *
+         * `comparison` tells that `function` is the builtin less, greater
+         * or equal; the kernels then evaluate it on the column's storage,
+         * and any other function is called for each selected row.
+         *
+         * @throws std::runtime_error on an unknown column, or a function
+         * that is a special form or takes other than one or two arguments
+         */
+        Table filter(const Object &conditions, const FunctionEntry &function, std::optional<VectorMath::Op> comparison) const;
+
+        /**
+         * @brief The named columns, in the order given
+         * @throws std::runtime_error on an unknown column
+         */
+        Table select(const std::vector<std::string> &names) const;
+
+        /**
+         * @brief The same rows, grouped by the values of one column
+         *
+         * Numbers and strings of packed and string columns are compared as
+         * such; elements of other arrays by their text. Groups are ordered
+         * by first appearance. filter and select return ungrouped tables.
+         *
+         * @throws std::runtime_error on an unknown column
+         */
+        Table groupBy(std::string_view name) const;
+
+        /**
+         * @brief One row per group (or a single row if ungrouped) reducing
+         * the columns named in `spec` with "sum", "mean", "min", "max" or
+         * "count"
+         *
+         * The result starts with the grouping column's keys, followed by
+         * one number column per entry of `spec`, named after its column.
+         * The reductions match the builtins of the same names, except that
+         * those with no value (the mean, min and max of no rows) are NaN.
+         *
+         * @throws std::runtime_error on an unknown column or reduction, or
+         * a column of non-numbers given to a numeric reduction
+         */
+        Table aggregate(const Object &spec) const;
+
+        /**
+         * @brief Tables are equal when their column names and selected
+         * rows are
+         */
+        bool operator==(const Table &other) const;
+
+    private:
+        struct Grouping
+        {
+            std::uint32_t keyColumn;
+            std::vector<std::uint32_t> firstRows; // Row where each group first appears
+            std::vector<std::uint32_t> groupOf;   // Group of each selected row
+        };
+
+        std::vector<std::string> names_;
+        std::vector<Value> columns_;
+        std::size_t rows_ = 0;
+        std::shared_ptr<const std::vector<std::uint32_t>> selection_; // Null when every row is selected
+        std::shared_ptr<const Grouping> grouping_;
+
+        std::uint32_t requireColumn(std::string_view name) const;
+        bool groupDense(const double *numbers, Grouping &grouping) const;
+        std::uint32_t rowAt(std::size_t position) const { return selection_ ? (*selection_)[position] : static_cast<std::uint32_t>(position); }
+    };
+
+} // namespace pangea
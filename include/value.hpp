@@ -1,21 +1,75 @@
 #pragma once
 
-#include <variant>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <cstring>
 #include <iostream>
 
 namespace pangea
 {
 
     class FunctionEntry; // Forward declaration
+    class Object;        // Defined in object.hpp
+    class Sequence;      // Defined in sequence.hpp
+    class Table;         // Defined in table.hpp
+    class OutputSink;    // Defined in output_sink.hpp
+
+    /**
+     * @brief Strings stored back to back in one buffer, the storage of a
+     * string column
+     *
+     * Element i spans bytes [offsets[i], offsets[i + 1]), so a column of
+     * n strings costs its bytes plus n + 1 offsets rather than n heap
+     * strings.
+     */
+    struct StringColumn
+    {
+        std::string bytes;
+        std::vector<std::uint64_t> offsets{0};
+
+        std::size_t size() const { return offsets.size() - 1; }
+        std::string_view at(std::size_t index) const
+        {
+            return std::string_view(bytes).substr(offsets[index], offsets[index + 1] - offsets[index]);
+        }
+        void push_back(std::string_view text)
+        {
+            bytes.append(text);
+            offsets.push_back(bytes.size());
+        }
+    };
 
     /**
      * @brief Represents all possible values in the Pangea language
      *
-     * Uses std::variant for type-safe value storage, equivalent to the Java Value class
+     * A Value is a single NaN-boxed 64-bit word. Numbers are stored as
+     * their IEEE-754 bits; null and booleans live in the payload of a
+     * negative quiet NaN, which no arithmetic result produces once NaNs
+     * are canonicalized. Integers between MinInteger and MaxInteger are
+     * stored inline as well, as a 50-bit two's complement payload; both
+     * kinds are Type::Number to the language. Strings, arrays, objects and functions are heap
+     * objects behind an intrusive reference count, whose pointer is
+     * stored in the same NaN space. Copying a Value copies 8 bytes and,
+     * for heap types, bumps the count; the heap object is shared until a
+     * mutable accessor detaches it (copy-on-write).
+     *
+     * Strings built with concat() may be ropes: a tree of pieces that is
+     * flattened into contiguous bytes on the first asString() call.
+     *
+     * Arrays whose elements are all numbers are packed: they store raw
+     * doubles, which the vectorized arithmetic works on directly. They are
+     * still arrays to the language; asArray() boxes their elements into a
+     * cached std::vector<Value>, and asArrayMutable() converts them back
+     * to a general array. Arrays of strings built as a StringColumn, such
+     * as the columns read_csv produces, keep that layout the same way.
+     * Tables hold such arrays as named columns (see Table).
+     *
+     * Reference counts are not atomic: a Value and its copies must not be
+     * used from several threads without external synchronization.
      */
     class Value
     {
@@ -28,61 +82,226 @@ namespace pangea
             Boolean,
             Array,
             Object,
-            Function
+            Function,
+            Sequence,
+            Table
+        };
+
+        /**
+         * @brief Header shared by all heap-allocated payloads
+         */
+        struct HeapObject
+        {
+            // How an Array stores its elements
+            enum class Layout : std::uint8_t
+            {
+                Values,  // Boxed Values
+                Numbers, // Raw doubles (packed)
+                Strings  // A StringColumn
+            };
+
+            std::uint32_t refCount = 1;
+            Type type;
+            Layout layout = Layout::Values;
+
+            explicit HeapObject(Type type) : type(type) {}
+            virtual ~HeapObject() = default;
+            virtual HeapObject *clone() const = 0;
         };
 
     private:
-        using ValueVariant = std::variant<
-            std::monostate,                         // Null
-            double,                                 // Number
-            std::string,                            // String
-            bool,                                   // Boolean
-            std::vector<Value>,                     // Array
-            std::unordered_map<std::string, Value>, // Object
-            std::shared_ptr<FunctionEntry>          // Function
-            >;
-
-        ValueVariant data_;
-        Type type_;
+        // Bit layout: tagged values have all of 0xFFF8 in their top bits
+        // (sign, exponent and quiet bit), a 3-bit tag in bits 48-50 and a
+        // 48-bit payload below. Integers take the tags 0xFFFC-0xFFFF, that
+        // is the top 14 bits, and keep a 50-bit payload
+        static constexpr std::uint64_t TaggedMask = 0xFFF8000000000000ULL;
+        static constexpr std::uint64_t TagMask = 0xFFFF000000000000ULL;
+        static constexpr std::uint64_t PayloadMask = 0x0000FFFFFFFFFFFFULL;
+        static constexpr std::uint64_t NullBits = 0xFFF9000000000000ULL;
+        static constexpr std::uint64_t BooleanTag = 0xFFFA000000000000ULL;
+        static constexpr std::uint64_t HeapTag = 0xFFFB000000000000ULL;
+        static constexpr std::uint64_t IntegerTag = 0xFFFC000000000000ULL;
+        static constexpr std::uint64_t IntegerPayloadMask = 0x0003FFFFFFFFFFFFULL;
+        static constexpr std::uint64_t CanonicalNaN = 0x7FF8000000000000ULL;
+
+        std::uint64_t bits_;
+
+        bool isDouble() const { return (bits_ & TaggedMask) != TaggedMask; }
+        std::int64_t integerPayload() const { return static_cast<std::int64_t>(bits_ << 14) >> 14; }
+
+        static std::uint64_t doubleBits(double value)
+        {
+            // Every NaN becomes the canonical one so the tagged space stays free
+            std::uint64_t bits = CanonicalNaN;
+            if (value == value)
+            {
+                std::memcpy(&bits, &value, sizeof(bits));
+            }
+            return bits;
+        }
+
+        bool isHeap() const { return (bits_ & TagMask) == HeapTag; }
+        HeapObject *heap() const { return reinterpret_cast<HeapObject *>(static_cast<std::uintptr_t>(bits_ & PayloadMask)); }
+        bool isHeapType(Type type) const { return isHeap() && heap()->type == type; }
+
+        explicit Value(HeapObject *object);
+        void retain() const
+        {
+            if (isHeap())
+            {
+                ++heap()->refCount;
+            }
+        }
+        void release()
+        {
+            // Inline so dropping a number or boolean costs one compare
+            if (isHeap() && --heap()->refCount == 0)
+            {
+                delete heap();
+            }
+            bits_ = NullBits;
+        }
+        HeapObject *detach(Type type, const char *error);
 
     public:
+        // Range of the inline integer representation
+        static constexpr std::int64_t MinInteger = -(std::int64_t(1) << 49);
+        static constexpr std::int64_t MaxInteger = (std::int64_t(1) << 49) - 1;
+
         // Constructors
-        Value();
-        explicit Value(double value);
+        Value() : bits_(NullBits) {}
+        explicit Value(double value) : bits_(doubleBits(value)) {}
+
+        /**
+         * @brief An integer, or the nearest double when it lies outside
+         * [MinInteger, MaxInteger]
+         */
+        explicit Value(std::int64_t value)
+            : bits_(value >= MinInteger && value <= MaxInteger
+                        ? IntegerTag | (static_cast<std::uint64_t>(value) & IntegerPayloadMask)
+                        : doubleBits(static_cast<double>(value))) {}
         explicit Value(const std::string &value);
-        explicit Value(bool value);
+        explicit Value(std::string &&value);
+        explicit Value(const char *value);
+        explicit Value(bool value) : bits_(BooleanTag | (value ? 1 : 0)) {}
         explicit Value(const std::vector<Value> &value);
+        explicit Value(std::vector<Value> &&value);
+        explicit Value(std::vector<double> numbers);
+        explicit Value(StringColumn strings);
+        explicit Value(const Object &value);
+        explicit Value(Object &&value);
         explicit Value(const std::unordered_map<std::string, Value> &value);
         explicit Value(std::shared_ptr<FunctionEntry> function);
+        explicit Value(Sequence sequence);
+        explicit Value(Table table);
 
         // Copy and move constructors/operators
-        Value(const Value &other) = default;
-        Value(Value &&other) noexcept = default;
-        Value &operator=(const Value &other) = default;
-        Value &operator=(Value &&other) noexcept = default;
+        Value(const Value &other) : bits_(other.bits_) { retain(); }
+        Value(Value &&other) noexcept : bits_(other.bits_) { other.bits_ = NullBits; }
+        Value &operator=(const Value &other)
+        {
+            other.retain();
+            release();
+            bits_ = other.bits_;
+            return *this;
+        }
+        Value &operator=(Value &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                bits_ = other.bits_;
+                other.bits_ = NullBits;
+            }
+            return *this;
+        }
+        ~Value() { release(); }
 
         // Type checkers
-        bool isNull() const { return type_ == Type::Null; }
-        bool isNumber() const { return type_ == Type::Number; }
-        bool isString() const { return type_ == Type::String; }
-        bool isBoolean() const { return type_ == Type::Boolean; }
-        bool isArray() const { return type_ == Type::Array; }
-        bool isObject() const { return type_ == Type::Object; }
-        bool isFunction() const { return type_ == Type::Function; }
+        bool isNull() const { return bits_ == NullBits; }
+        bool isNumber() const { return isDouble() || isInteger(); }
+        bool isInteger() const { return (bits_ & IntegerTag) == IntegerTag; }
+        bool isString() const { return isHeapType(Type::String); }
+        bool isBoolean() const { return (bits_ & TagMask) == BooleanTag; }
+        bool isArray() const { return isHeapType(Type::Array); }
+        bool isNumberArray() const { return isArray() && heap()->layout == HeapObject::Layout::Numbers; }
+        bool isStringArray() const { return isArray() && heap()->layout == HeapObject::Layout::Strings; }
+        bool isObject() const { return isHeapType(Type::Object); }
+        bool isFunction() const { return isHeapType(Type::Function); }
+        bool isSequence() const { return isHeapType(Type::Sequence); }
+        bool isTable() const { return isHeapType(Type::Table); }
+
+        Type getType() const;
 
-        Type getType() const { return type_; }
+        /**
+         * @brief Whether this value's heap storage is shared with another
+         * Value (always false for inline types)
+         */
+        bool isShared() const { return isHeap() && heap()->refCount > 1; }
 
-        // Value getters (with type checking)
+        /**
+         * @brief Whether both values are the same word: the same number bits
+         * or the same heap object
+         */
+        bool isIdentical(const Value &other) const { return bits_ == other.bits_; }
+
+        /**
+         * @brief Concatenate two strings in O(1)
+         *
+         * Long results are represented as a rope node referencing both
+         * operands; short ones are copied into a flat string right away.
+         */
+        static Value concat(const Value &left, const Value &right);
+
+        /**
+         * @brief Make this value the string `text`, reusing its string
+         * storage when no other Value shares it
+         *
+         * Lets a producer of many short-lived strings, such as a line
+         * reader, allocate only for the strings that are kept.
+         */
+        void assignString(std::string_view text);
+
+        /**
+         * @brief Length of a string in bytes, without flattening a rope
+         */
+        std::size_t stringLength() const;
+
+        // Value getters (with type checking); asNumber() converts integers
         double asNumber() const;
+        std::int64_t asInteger() const;
         const std::string &asString() const;
         bool asBoolean() const;
         const std::vector<Value> &asArray() const;
-        const std::unordered_map<std::string, Value> &asObject() const;
+        const Object &asObject() const;
         std::shared_ptr<FunctionEntry> asFunction() const;
+        const Sequence &asSequence() const;
+        const Table &asTable() const;
+
+        /**
+         * @brief Elements of a packed number array
+         */
+        const std::vector<double> &asNumberArray() const;
 
-        // Mutable getters for modification
+        /**
+         * @brief Elements of an array stored as a StringColumn
+         */
+        const StringColumn &asStringArray() const;
+
+        /**
+         * @brief Number of elements of any array, without boxing
+         */
+        std::size_t arraySize() const;
+
+        /**
+         * @brief Element of any array by index, without boxing the others
+         */
+        Value arrayAt(std::size_t index) const;
+
+        // Mutable getters for modification; shared storage is copied first
         std::vector<Value> &asArrayMutable();
-        std::unordered_map<std::string, Value> &asObjectMutable();
+        std::vector<double> &asNumberArrayMutable();
+        Object &asObjectMutable();
 
         // Truthiness evaluation (like JavaScript)
         bool isTruthy() const;
@@ -90,6 +309,14 @@ namespace pangea
         // String conversion
         std::string toString() const;
 
+        /**
+         * @brief Write the same text as toString() into a sink, piece by
+         * piece, without building it as a string first
+         *
+         * Numbers use the shortest text that reads back as the same double.
+         */
+        void writeTo(OutputSink &sink) const;
+
         // Utility methods
         void print(std::ostream &os = std::cout) const;
 
@@ -98,6 +325,8 @@ namespace pangea
         bool operator!=(const Value &other) const { return !(*this == other); }
     };
 
+    static_assert(sizeof(Value) == 8, "Value must stay a single NaN-boxed word");
+
     // Stream operator for easy printing
     std::ostream &operator<<(std::ostream &os, const Value &value);
 
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pangea
+{
+
+    /**
+     * @brief Vectorized kernels over packed arrays of doubles
+     *
+     * Mirrors Scanner: the SSE2 and AVX2 backends process 2 or 4 doubles
+     * per instruction, the scalar backend is the reference and the fallback
+     * on other targets, and the best supported backend is picked at runtime
+     * on first use.
+     */
+    class VectorMath
+    {
+    public:
+        enum class Backend
+        {
+            Scalar,
+            SSE2,
+            AVX2
+        };
+
+        /**
+         * @brief Element-wise operations; comparisons yield 1.0 or 0.0
+         *
+         * There is no vector pow instruction, so Power runs the scalar
+         * loop on every backend.
+         */
+        enum class Op
+        {
+            Add,
+            Subtract,
+            Multiply,
+            Divide,
+            Power,
+            Less,
+            Greater,
+            Equal
+        };
+
+        /**
+         * @brief out[i] = a[i] op b[i] for i < n
+         *
+         * A broadcast operand is a single value applied to every element.
+         * `out` may alias either input.
+         */
+        static void apply(Op op, const double *a, bool broadcastA, const double *b, bool broadcastB, double *out, std::size_t n);
+
+        /**
+         * @brief Positions i < n where `data[i] op operand` holds, written
+         * in increasing order to `out`, which needs room for n
+         *
+         * Builds a filter's selection vector in one pass, without a 1.0/0.0
+         * array in between. `op` must be Less, Greater or Equal.
+         *
+         * @return The number of positions written
+         */
+        static std::size_t select(Op op, const double *data, double operand, std::uint32_t *out, std::size_t n);
+
+        /**
+         * @brief Compensated (Neumaier) sum, accurate for long inputs of
+         * mixed magnitude; each SIMD lane keeps its own compensation term
+         */
+        static double sum(const double *data, std::size_t n);
+
+        /**
+         * @brief Sum of a[i] * b[i], compensated like sum()
+         */
+        static double dot(const double *a, const double *b, std::size_t n);
+
+        /**
+         * @brief Smallest and largest element of a non-empty array; NaN if
+         * any element is NaN
+         */
+        static double min(const double *data, std::size_t n);
+        static double max(const double *data, std::size_t n);
+
+        /**
+         * @brief Index of the first largest element of a non-empty array,
+         * or of the first NaN
+         */
+        static std::size_t argmax(const double *data, std::size_t n);
+
+        /**
+         * @brief Number of elements that are not zero (NaN counts)
+         */
+        static std::size_t countNonZero(const double *data, std::size_t n);
+
+        static Backend getBackend();
+        static void setBackend(Backend backend);
+        static bool isSupported(Backend backend);
+        static Backend getBestBackend();
+        static std::string getBackendName(Backend backend);
+    };
+
+    /**
+     * @brief Neumaier summation of per-block results, matching the
+     * kernels' own compensation within a block
+     */
+    struct CompensatedSum
+    {
+        double sum = 0.0;
+        double compensation = 0.0;
+
+        void add(double x)
+        {
+            double total = sum + x;
+            compensation += std::fabs(sum) >= std::fabs(x) ? (sum - total) + x : (x - total) + sum;
+            sum = total;
+        }
+
+        double value() const { return sum + compensation; }
+    };
+
+} // namespace pangea
@@ -0,0 +1,369 @@
+#include "csv_reader.hpp"
+#include "mapped_file.hpp"
+#include "object.hpp"
+#include "scanner.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace pangea
+{
+
+    namespace
+    {
+        // Splits delimited text into records and fields, one field at a
+        // time. A field views the text unless it is quoted with doubled
+        // quotes inside; then it is unescaped into a buffer that the next
+        // field reuses, so fields must be consumed as they are read
+        class FieldReader
+        {
+        public:
+            FieldReader(std::string_view text, char delimiter) : text_(text), delimiter_(delimiter) {}
+
+            std::size_t position() const { return position_; }
+
+            // Moves to the next record, past any blank lines; false at the
+            // end of the text
+            bool startRecord()
+            {
+                while (position_ < text_.size())
+                {
+                    if (text_[position_] == '\n')
+                    {
+                        ++position_;
+                    }
+                    else if (text_[position_] == '\r' && position_ + 1 < text_.size() && text_[position_ + 1] == '\n')
+                    {
+                        position_ += 2;
+                    }
+                    else
+                    {
+                        ++record_;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Reads the next field of the record; false if it was the last
+            bool next(std::string_view &field)
+            {
+                const char *data = text_.data();
+                const std::size_t size = text_.size();
+                std::size_t end;
+                if (position_ < size && data[position_] == '"')
+                {
+                    field = quoted();
+                    end = position_;
+                    if (end < size && data[end] == '\r' && (end + 1 == size || data[end + 1] == '\n'))
+                    {
+                        ++end;
+                    }
+                    if (end < size && data[end] != delimiter_ && data[end] != '\n')
+                    {
+                        fail("Unexpected text after a quoted field");
+                    }
+                }
+                else
+                {
+                    // A quote inside an unquoted field is kept as it is
+                    std::size_t start = position_;
+                    end = findStop(start);
+                    while (end < size && data[end] == '"')
+                    {
+                        end = findStop(end + 1);
+                    }
+                    field = text_.substr(start, end - start);
+                    if ((end == size || data[end] == '\n') && !field.empty() && field.back() == '\r')
+                    {
+                        field.remove_suffix(1);
+                    }
+                }
+
+                if (end >= size)
+                {
+                    position_ = size;
+                    return false;
+                }
+                position_ = end + 1;
+                return data[end] == delimiter_;
+            }
+
+            [[noreturn]] void fail(const char *problem) const
+            {
+                throw std::runtime_error(std::string(problem) + " in CSV record " + std::to_string(record_));
+            }
+
+        private:
+            std::string_view text_;
+            char delimiter_;
+            std::size_t position_ = 0;
+            std::size_t record_ = 0; // 1-based number of the current record
+            std::string unescaped_;
+            std::size_t block_ = SIZE_MAX; // Start of the block stops_ describes
+            std::uint64_t stops_ = 0;
+
+            // The first delimiter, quote or line feed at or after `pos`, or
+            // the end of the text; each block is classified once
+            std::size_t findStop(std::size_t pos)
+            {
+                const std::size_t size = text_.size();
+                while (pos < size)
+                {
+                    std::size_t block = pos - pos % Scanner::FieldBlockSize;
+                    if (block != block_)
+                    {
+                        classify(block);
+                    }
+                    if (std::uint64_t ahead = stops_ >> (pos - block))
+                    {
+                        return std::min(pos + static_cast<std::size_t>(std::countr_zero(ahead)), size);
+                    }
+                    pos = block + Scanner::FieldBlockSize;
+                }
+                return size;
+            }
+
+            void classify(std::size_t block)
+            {
+                block_ = block;
+                if (block + Scanner::FieldBlockSize <= text_.size())
+                {
+                    stops_ = Scanner::fieldStops(text_.data() + block, delimiter_);
+                    return;
+                }
+
+                // The last block is partial: classify a padded copy; stops in
+                // the padding lie past the end and are clamped to it
+                char padded[Scanner::FieldBlockSize] = {};
+                std::memcpy(padded, text_.data() + block, text_.size() - block);
+                stops_ = Scanner::fieldStops(padded, delimiter_);
+            }
+
+            // Reads the quoted field at position_ and leaves position_ after
+            // its closing quote
+            std::string_view quoted()
+            {
+                const char *data = text_.data();
+                const std::size_t size = text_.size();
+                const std::size_t start = position_ + 1;
+                std::size_t from = start;
+                bool escaped = false;
+                while (true)
+                {
+                    const void *found = from < size ? std::memchr(data + from, '"', size - from) : nullptr;
+                    if (!found)
+                    {
+                        fail("Unterminated quoted field");
+                    }
+                    std::size_t quote = static_cast<std::size_t>(static_cast<const char *>(found) - data);
+                    bool doubled = quote + 1 < size && data[quote + 1] == '"';
+
+                    // Most quoted fields have no doubled quotes and are
+                    // returned in place
+                    if (!escaped && !doubled)
+                    {
+                        position_ = quote + 1;
+                        return text_.substr(start, quote - start);
+                    }
+                    if (!escaped)
+                    {
+                        unescaped_.clear();
+                        escaped = true;
+                    }
+                    unescaped_.append(data + from, quote - from);
+                    if (!doubled)
+                    {
+                        position_ = quote + 1;
+                        return unescaped_;
+                    }
+                    unescaped_ += '"';
+                    from = quote + 2;
+                }
+            }
+        };
+
+        // Same shape as number literals in source: [+-][.]digit... The
+        // text is not empty
+        bool parseNumber(std::string_view text, double &number)
+        {
+            // Plain digits, the usual case for ids and counts, are summed
+            // directly; up to 15 of them are exact in a double
+            if (text.size() <= 15)
+            {
+                std::uint64_t integer = 0;
+                std::size_t i = 0;
+                for (; i < text.size() && static_cast<unsigned char>(text[i] - '0') <= 9; ++i)
+                {
+                    integer = integer * 10 + static_cast<unsigned>(text[i] - '0');
+                }
+                if (i == text.size())
+                {
+                    number = static_cast<double>(integer);
+                    return true;
+                }
+            }
+
+            std::size_t digit = (text.front() == '+' || text.front() == '-') ? 1 : 0;
+            if (digit < text.size() && text[digit] == '.')
+            {
+                ++digit;
+            }
+            if (digit >= text.size() || text[digit] < '0' || text[digit] > '9')
+            {
+                return false;
+            }
+            const char *first = text.data() + (text.front() == '+' ? 1 : 0);
+            const char *last = text.data() + text.size();
+            auto [end, error] = std::from_chars(first, last, number);
+            return error == std::errc() && end == last;
+        }
+
+        // A column stays numeric until a field is neither a number nor empty.
+        // Until then `starts` keeps where each number's text begins in the
+        // body, so the column can turn into strings without reading the
+        // records again
+        struct Column
+        {
+            bool numeric = true;
+            std::vector<double> numbers;
+            std::vector<std::size_t> starts;
+            StringColumn strings;
+        };
+
+        // Turns a numeric column into a string one, recovering each
+        // number's original text from where it starts. The text of a number
+        // holds no quote, line break or delimiter (its field would have
+        // ended there), so it ends at the first of them. Only empty fields
+        // are stored as NaN, since the text of a number is never "nan"
+        void toStrings(Column &column, std::string_view body, char delimiter)
+        {
+            column.numeric = false;
+            column.strings.offsets.reserve(column.numbers.size() + 1);
+            for (std::size_t i = 0; i < column.numbers.size(); ++i)
+            {
+                if (std::isnan(column.numbers[i]))
+                {
+                    column.strings.push_back({});
+                    continue;
+                }
+                auto begin = body.begin() + static_cast<std::ptrdiff_t>(column.starts[i]);
+                auto end = std::find_if(begin, body.end(), [delimiter](char c)
+                                        { return c == delimiter || c == '"' || c == '\n' || c == '\r'; });
+                column.strings.push_back(std::string_view(&*begin, static_cast<std::size_t>(end - begin)));
+            }
+            column.numbers = {};
+            column.starts = {};
+        }
+
+        // Records read before the columns are sized for the whole text
+        constexpr std::size_t SampleRecords = 1024;
+
+        // Reserves room for `scale` times the records read so far, so the
+        // columns are not copied as they grow. A little extra is reserved
+        // since the sample only estimates the length of a record
+        void reserve(std::vector<Column> &columns, std::size_t records, double scale)
+        {
+            scale *= 1.05;
+            auto expected = static_cast<std::size_t>(static_cast<double>(records) * scale);
+            for (Column &column : columns)
+            {
+                if (column.numeric)
+                {
+                    column.numbers.reserve(expected);
+                    column.starts.reserve(expected);
+                }
+                else
+                {
+                    column.strings.offsets.reserve(expected + 1);
+                    column.strings.bytes.reserve(static_cast<std::size_t>(static_cast<double>(column.strings.bytes.size()) * scale));
+                }
+            }
+        }
+
+        void store(Column &column, std::string_view field, std::string_view body, char delimiter)
+        {
+            if (column.numeric)
+            {
+                double number = std::numeric_limits<double>::quiet_NaN();
+                if (field.empty() || parseNumber(field, number))
+                {
+                    // A number is never unescaped, so its field views the body
+                    column.numbers.push_back(number);
+                    column.starts.push_back(field.empty() ? 0 : static_cast<std::size_t>(field.data() - body.data()));
+                    return;
+                }
+                toStrings(column, body, delimiter);
+            }
+            column.strings.push_back(field);
+        }
+    } // namespace
+
+    Value CsvReader::parse(std::string_view text, char delimiter)
+    {
+        FieldReader reader(text, delimiter);
+        Object table;
+        if (!reader.startRecord())
+        {
+            return Value(std::move(table));
+        }
+
+        // The header gives the columns their names and slots
+        std::vector<Column> columns;
+        std::string_view field;
+        for (bool more = true; more;)
+        {
+            more = reader.next(field);
+            if (table.findSlot(field) != Object::NotFound)
+            {
+                throw std::runtime_error("Duplicate CSV column: " + std::string(field));
+            }
+            table.set(field, Value());
+            columns.emplace_back();
+        }
+
+        const std::size_t bodyStart = reader.position();
+        const std::string_view body = text.substr(bodyStart);
+        std::size_t records = 0;
+        while (reader.startRecord())
+        {
+            std::size_t index = 0;
+            for (bool more = true; more; ++index)
+            {
+                more = reader.next(field);
+                if (index == columns.size())
+                {
+                    reader.fail("More fields than the header has columns");
+                }
+                store(columns[index], field, body, delimiter);
+            }
+            for (; index < columns.size(); ++index)
+            {
+                store(columns[index], {}, body, delimiter);
+            }
+            if (++records == SampleRecords)
+            {
+                reserve(columns, records, static_cast<double>(body.size()) / static_cast<double>(reader.position() - bodyStart));
+            }
+        }
+
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            Column &column = columns[i];
+            table.valueAt(static_cast<std::uint32_t>(i)) = column.numeric ? Value(std::move(column.numbers)) : Value(std::move(column.strings));
+        }
+        return Value(std::move(table));
+    }
+
+    Value CsvReader::read(const std::string &path, char delimiter)
+    {
+        MappedFile file(path);
+        return parse(file.text(), delimiter);
+    }
+
+} // namespace pangea
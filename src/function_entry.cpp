@@ -1,5 +1,6 @@
 #include "function_entry.hpp"
 #include "interpreter.hpp"
+#include <iterator>
 #include <stdexcept>
 
 namespace pangea
@@ -7,20 +8,34 @@ namespace pangea
 
     // Constructors
     FunctionEntry::FunctionEntry()
-        : arity_(0), operatorType_(OperatorType::Prefix), function_(nullptr), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(false)
+        : arity_(0), operatorType_(OperatorType::Prefix), function_(nullptr), fastFunction_(nullptr), specialFunction_(nullptr), fastContext_(nullptr), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(false)
     {
     }
 
     FunctionEntry::FunctionEntry(int arity, OperatorType operatorType, NativeFunction function)
-        : arity_(arity), operatorType_(operatorType), function_(std::move(function)), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(false)
+        : arity_(arity), operatorType_(operatorType), function_(std::move(function)), fastFunction_(nullptr), specialFunction_(nullptr), fastContext_(nullptr), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(false)
     {
     }
 
-    FunctionEntry::FunctionEntry(const std::string &name, int arity, BuiltinFunction function)
-        : arity_(arity), operatorType_(OperatorType::Prefix), builtinFunction_(std::move(function)), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(true)
+    FunctionEntry::FunctionEntry([[maybe_unused]] const std::string &name, int arity, BuiltinFunction function)
+        : arity_(arity), operatorType_(OperatorType::Prefix), builtinFunction_(std::move(function)), fastFunction_(nullptr), specialFunction_(nullptr), fastContext_(nullptr), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(true)
     {
     }
 
+    FunctionEntry::FunctionEntry([[maybe_unused]] const std::string &name, int arity, FastFunction function, void *context)
+        : arity_(arity), operatorType_(OperatorType::Prefix), fastFunction_(function), specialFunction_(nullptr), fastContext_(context), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(true)
+    {
+    }
+
+    FunctionEntry::FunctionEntry(const std::string &name, int arity, SpecialFunction function, void *context)
+        : arity_(arity), operatorType_(OperatorType::Prefix), fastFunction_(nullptr), specialFunction_(function), fastContext_(context), wordIndex_(-1), boundContext_(nullptr), isLambda_(false), methodArity_(-1), isMethod_(false), functionType_(FunctionType::Native), isBuiltin_(true)
+    {
+        if (arity < 1 || arity > MaxSpecialArity)
+        {
+            throw std::runtime_error("Special form " + name + " must take 1 to " + std::to_string(MaxSpecialArity) + " arguments");
+        }
+    }
+
     // Utility methods
     int FunctionEntry::getEffectiveArity() const
     {
@@ -102,14 +117,35 @@ namespace pangea
         return function_(params, interpreter);
     }
 
-    Value FunctionEntry::invoke(const std::vector<Value> &args) const
+    Value FunctionEntry::invoke(ValueSpan args) const
     {
+        if (fastFunction_)
+        {
+            return fastFunction_(fastContext_, args);
+        }
+
+        if (specialFunction_)
+        {
+            throw std::runtime_error("A special form cannot be called with evaluated arguments");
+        }
+
         if (!isBuiltin_ || !builtinFunction_)
         {
             throw std::runtime_error("Function is not a builtin function or implementation is null");
         }
 
-        return builtinFunction_(args);
+        // The std::vector API needs its own container; the arguments are
+        // moved into it since the caller discards them afterwards
+        return builtinFunction_(std::vector<Value>(std::make_move_iterator(args.begin()), std::make_move_iterator(args.end())));
+    }
+
+    Value FunctionEntry::invokeSpecial(PhraseSpan args) const
+    {
+        if (!specialFunction_)
+        {
+            throw std::runtime_error("Function is not a special form");
+        }
+        return specialFunction_(fastContext_, args);
     }
 
 } // namespace pangea
@@ -0,0 +1,180 @@
+#include "input_source.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace pangea
+{
+
+    InputSource::InputSource(std::size_t capacity)
+        : storage_(std::make_unique_for_overwrite<char[]>(capacity > 0 ? capacity : 1)), data_(storage_.get()), capacity_(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    void InputSource::setContents(std::string_view contents)
+    {
+        storage_.reset();
+        data_ = contents.data();
+        capacity_ = contents.size();
+        begin_ = 0;
+        end_ = contents.size();
+        exhausted_ = true;
+    }
+
+    std::string_view InputSource::take(std::size_t length, std::size_t next)
+    {
+        std::string_view line(data_ + begin_, length);
+
+        // Lines before this one are no longer needed by the reader
+        if (!storage_ && begin_ - reported_ >= ReleaseInterval)
+        {
+            reported_ = begin_;
+            consumed(begin_);
+        }
+        begin_ = next;
+        return line;
+    }
+
+    bool InputSource::readLine(std::string_view &line)
+    {
+        std::size_t scanned = begin_;
+        while (true)
+        {
+            if (const void *newline = std::memchr(data_ + scanned, '\n', end_ - scanned))
+            {
+                std::size_t lineEnd = static_cast<std::size_t>(static_cast<const char *>(newline) - data_);
+                std::size_t length = lineEnd - begin_;
+                if (length > 0 && data_[lineEnd - 1] == '\r')
+                {
+                    --length;
+                }
+                line = take(length, lineEnd + 1);
+                return true;
+            }
+
+            if (exhausted_)
+            {
+                if (begin_ == end_)
+                {
+                    return false;
+                }
+                line = take(end_ - begin_, end_);
+                return true;
+            }
+
+            // Keep the partial line at the front and read behind it; only a
+            // line filling the whole buffer makes it grow
+            std::size_t pending = end_ - begin_;
+            if (begin_ > 0)
+            {
+                std::memmove(storage_.get(), storage_.get() + begin_, pending);
+                begin_ = 0;
+                end_ = pending;
+            }
+            else if (end_ == capacity_)
+            {
+                auto larger = std::make_unique_for_overwrite<char[]>(capacity_ * 2);
+                std::memcpy(larger.get(), storage_.get(), end_);
+                storage_ = std::move(larger);
+                data_ = storage_.get();
+                capacity_ *= 2;
+            }
+            scanned = end_;
+
+            std::size_t count = fill(storage_.get() + end_, capacity_ - end_);
+            if (count == 0)
+            {
+                exhausted_ = true;
+            }
+            end_ += count;
+        }
+    }
+
+    namespace
+    {
+        // A mapped file split in place; pages behind the lines handed out
+        // are released, so reading a large file does not accumulate them
+        class MappedSource : public InputSource
+        {
+        public:
+            explicit MappedSource(MappedFile file) : InputSource(1), file_(std::move(file)) { setContents(file_.text()); }
+
+        protected:
+            std::size_t fill(char *, std::size_t) override { return 0; }
+            void consumed(std::size_t offset) override { file_.release(offset); }
+
+        private:
+            MappedFile file_;
+        };
+    } // namespace
+
+    std::unique_ptr<InputSource> InputSource::open(const std::string &path)
+    {
+        if (MappedFile::isMappable(path))
+        {
+            return std::make_unique<MappedSource>(MappedFile(path));
+        }
+
+#if defined(_WIN32)
+        int descriptor = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+#endif
+        if (descriptor < 0)
+        {
+            throw std::runtime_error("Cannot open file: " + path + " (" + std::strerror(errno) + ")");
+        }
+        return std::make_unique<FileSource>(descriptor, DefaultCapacity, true);
+    }
+
+    FileSource::~FileSource()
+    {
+        if (owned_)
+        {
+#if defined(_WIN32)
+            ::_close(descriptor_);
+#else
+            ::close(descriptor_);
+#endif
+        }
+    }
+
+    std::size_t FileSource::fill(char *buffer, std::size_t size)
+    {
+        while (true)
+        {
+#if defined(_WIN32)
+            int count = ::_read(descriptor_, buffer, static_cast<unsigned>(std::min<std::size_t>(size, INT_MAX)));
+#else
+            ssize_t count = ::read(descriptor_, buffer, size);
+#endif
+            if (count >= 0)
+            {
+                return static_cast<std::size_t>(count);
+            }
+            if (errno != EINTR)
+            {
+                throw std::runtime_error(std::string("Cannot read input: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    std::size_t StringSource::fill(char *buffer, std::size_t size)
+    {
+        std::size_t count = std::min(size, text_.size() - position_);
+        std::memcpy(buffer, text_.data() + position_, count);
+        position_ += count;
+        return count;
+    }
+
+} // namespace pangea
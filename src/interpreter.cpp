@@ -1,171 +1,477 @@
 #include "interpreter.hpp"
-#include <iostream>
+#include "csv_reader.hpp"
+#include "output_sink.hpp"
+#include "table.hpp"
+#include "vector_math.hpp"
 #include <sstream>
 #include <algorithm>
 #include <stdexcept>
 #include <cmath>
+#include <array>
+#include <optional>
+#include <span>
 
 namespace pangea
 {
 
-    Interpreter::Interpreter()
-    {
-        initBuiltins();
-    }
-
-    void Interpreter::initBuiltins()
+    namespace
     {
-        // Arithmetic operators
-        registerBuiltin("plus", 2, [this](const std::vector<Value> &args)
-                        { return plus(args[0], args[1]); });
+        // Arithmetic and comparisons apply element-wise when one operand is
+        // a packed number array and the other a number or such an array
+        bool isElementwise(const Value &a, const Value &b)
+        {
+            return (a.isNumberArray() && (b.isNumber() || b.isNumberArray())) || (a.isNumber() && b.isNumberArray());
+        }
 
-        registerBuiltin("minus", 2, [this](const std::vector<Value> &args)
-                        { return minus(args[0], args[1]); });
+        Value elementwise(VectorMath::Op op, Value a, Value b)
+        {
+            const bool broadcastA = a.isNumber();
+            const bool broadcastB = b.isNumber();
+            const double scalarA = broadcastA ? a.asNumber() : 0.0;
+            const double scalarB = broadcastB ? b.asNumber() : 0.0;
+            const std::size_t size = broadcastA ? b.arraySize() : a.arraySize();
+            if (!broadcastA && !broadcastB && b.arraySize() != size)
+            {
+                throw std::runtime_error("Array lengths differ: " + std::to_string(size) + " and " + std::to_string(b.arraySize()));
+            }
 
-        registerBuiltin("times", 2, [this](const std::vector<Value> &args)
-                        { return times(args[0], args[1]); });
+            // An operand nobody else references is overwritten with the
+            // result instead of allocating a new array
+            Value result;
+            if (!broadcastA && !a.isShared())
+            {
+                result = std::move(a);
+            }
+            else if (!broadcastB && !b.isShared())
+            {
+                result = std::move(b);
+            }
+            else
+            {
+                result = Value(std::vector<double>(size));
+            }
 
-        registerBuiltin("divide", 2, [this](const std::vector<Value> &args)
-                        { return divide(args[0], args[1]); });
+            std::vector<double> &out = result.asNumberArrayMutable();
+            const double *x = broadcastA ? &scalarA : (a.isNull() ? out.data() : a.asNumberArray().data());
+            const double *y = broadcastB ? &scalarB : (b.isNull() ? out.data() : b.asNumberArray().data());
+            VectorMath::apply(op, x, broadcastA, y, broadcastB, out.data(), size);
+            return result;
+        }
 
-        registerBuiltin("power", 2, [this](const std::vector<Value> &args)
-                        { return power(args[0], args[1]); });
+        // Streams the numbers of an array or sequence to the reductions in
+        // blocks: a packed array's buffer in one piece, anything else
+        // through a fixed buffer, so a sequence is never materialized
+        class NumberBlocks
+        {
+        public:
+            NumberBlocks(const Value &value, const char *name) : value_(value), name_(name)
+            {
+                if (value.isSequence())
+                {
+                    cursor_.emplace(value.asSequence());
+                }
+                else if (!value.isArray())
+                {
+                    throw std::runtime_error(std::string(name) + " expects an array or a sequence");
+                }
+            }
 
-        // Comparison operators
-        registerBuiltin("equal", 2, [this](const std::vector<Value> &args)
-                        { return equal(args[0], args[1]); });
+            // The next block, empty once every number was produced
+            std::span<const double> next()
+            {
+                if (value_.isNumberArray())
+                {
+                    std::span<const double> numbers(value_.asNumberArray());
+                    std::size_t start = position_;
+                    position_ = numbers.size();
+                    return numbers.subspan(start);
+                }
 
-        registerBuiltin("less", 2, [this](const std::vector<Value> &args)
-                        { return less(args[0], args[1]); });
+                std::size_t filled = 0;
+                Value item;
+                while (filled < BlockSize && pull(item))
+                {
+                    if (!item.isNumber())
+                    {
+                        throw std::runtime_error(std::string(name_) + " expects numbers");
+                    }
+                    buffer_[filled++] = item.asNumber();
+                }
+                return {buffer_.data(), filled};
+            }
 
-        registerBuiltin("greater", 2, [this](const std::vector<Value> &args)
-                        { return greater(args[0], args[1]); });
+        private:
+            static constexpr std::size_t BlockSize = 1024;
 
-        // Logical operators
-        registerBuiltin("and", 2, [this](const std::vector<Value> &args)
-                        { return logicalAnd(args[0], args[1]); });
+            const Value &value_;
+            const char *name_;
+            std::optional<Sequence::Cursor> cursor_;
+            std::size_t position_ = 0;
+            std::array<double, BlockSize> buffer_;
 
-        registerBuiltin("or", 2, [this](const std::vector<Value> &args)
-                        { return logicalOr(args[0], args[1]); });
+            bool pull(Value &item)
+            {
+                if (cursor_)
+                {
+                    return cursor_->next(item);
+                }
+                if (position_ >= value_.arraySize())
+                {
+                    return false;
+                }
+                item = value_.arrayAt(position_++);
+                return true;
+            }
+        };
 
-        registerBuiltin("not", 1, [this](const std::vector<Value> &args)
-                        { return logicalNot(args[0]); });
+        // Smallest or largest of the numbers; null if there are none
+        template <bool Max>
+        Value extreme(const Value &collection, const char *name)
+        {
+            NumberBlocks blocks(collection, name);
+            bool empty = true;
+            double best = 0.0;
+            for (auto block = blocks.next(); !block.empty(); block = blocks.next())
+            {
+                double candidate = Max ? VectorMath::max(block.data(), block.size()) : VectorMath::min(block.data(), block.size());
+                if (std::isnan(candidate))
+                {
+                    return Value(candidate);
+                }
+                if (empty || (Max ? candidate > best : candidate < best))
+                {
+                    best = candidate;
+                }
+                empty = false;
+            }
+            return empty ? Value() : Value(best);
+        }
+    } // namespace
 
-        // I/O operations
-        registerBuiltin("print", 1, [this](const std::vector<Value> &args)
-                        {
-        print(args[0]);
-        return Value(); });
+    Interpreter::Interpreter()
+        : output_(std::make_unique<FileSink>(1, OutputBlockSize)), input_(std::make_unique<FileSource>())
+    {
+        initBuiltins();
+    }
 
-        registerBuiltin("println", 1, [this](const std::vector<Value> &args)
-                        {
-        println(args[0]);
-        return Value(); });
+    Interpreter::~Interpreter()
+    {
+        // A moved-from interpreter has no sink; a failing destination must
+        // not throw out of a destructor
+        if (output_)
+        {
+            try
+            {
+                output_->flush();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
 
-        registerBuiltin("input", 0, [this](const std::vector<Value> &args)
-                        { return input(); });
+    void Interpreter::setOutput(std::unique_ptr<OutputSink> output)
+    {
+        output_->flush();
+        output_ = std::move(output);
+    }
 
-        // Control flow
-        registerBuiltin("if", 3, [this](const std::vector<Value> &args)
-                        { return ifCondition(args[0], args[1], args[2]); });
+    void Interpreter::initBuiltins()
+    {
+        // Member builtins go through MemberThunk, so calling them needs no
+        // std::function and no argument vector
 
-        registerBuiltin("times_loop", 2, [this](const std::vector<Value> &args)
-                        { return timesLoop(args[0], args[1]); });
+        // Arithmetic operators
+        registerBuiltin<&Interpreter::plus>("plus");
+        registerBuiltin<&Interpreter::minus>("minus");
+        registerBuiltin<&Interpreter::times>("times");
+        registerBuiltin<&Interpreter::divide>("divide");
+        registerBuiltin<&Interpreter::power>("power");
 
-        registerBuiltin("each", 2, [this](const std::vector<Value> &args)
-                        { return each(args[0], args[1]); });
+        // Comparison operators
+        registerBuiltin<&Interpreter::equal>("equal");
+        registerBuiltin<&Interpreter::less>("less");
+        registerBuiltin<&Interpreter::greater>("greater");
 
-        // Utility functions
-        registerBuiltin("length", 1, [this](const std::vector<Value> &args)
-                        { return length(args[0]); });
+        // Logical operators
+        registerSpecialForm<&Interpreter::logicalAnd>("and");
+        registerSpecialForm<&Interpreter::logicalOr>("or");
+        registerBuiltin<&Interpreter::logicalNot>("not");
 
-        registerBuiltin("type", 1, [this](const std::vector<Value> &args)
-                        { return type(args[0]); });
+        // I/O operations
+        registerBuiltin<&Interpreter::print>("print");
+        registerBuiltin<&Interpreter::println>("println");
+        registerBuiltin<&Interpreter::input>("input");
+        registerBuiltin<&Interpreter::lines>("lines");
+        registerBuiltin<&Interpreter::readFile>("read_file");
+        registerBuiltin<&Interpreter::fileLines>("file_lines");
+        registerBuiltin<&Interpreter::fileSize>("file_size");
+        registerBuiltin<&Interpreter::readCsv>("read_csv");
+        registerBuiltin<&Interpreter::readTsv>("read_tsv");
+        registerBuiltin<&Interpreter::flushOutput>("flush");
 
-        registerBuiltin("string", 1, [this](const std::vector<Value> &args)
-                        { return toString(args[0]); });
+        // Control flow
+        registerSpecialForm<&Interpreter::ifCondition>("if");
+        registerSpecialForm<&Interpreter::timesLoop>("times_loop");
+        registerSpecialForm<&Interpreter::each>("each");
+        registerBuiltin<&Interpreter::loopIndex>("index");
+        registerBuiltin<&Interpreter::loopKey>("key");
+        registerBuiltin<&Interpreter::loopValue>("value");
+        registerBuiltin<&Interpreter::stopLoop>("stop");
 
-        registerBuiltin("number", 1, [this](const std::vector<Value> &args)
-                        { return toNumber(args[0]); });
+        // Utility functions
+        registerBuiltin<&Interpreter::length>("length");
+        registerBuiltin<&Interpreter::type>("type");
+        registerBuiltin<&Interpreter::toString>("string");
+        registerBuiltin<&Interpreter::toNumber>("number");
+        registerBuiltin<&Interpreter::join>("join");
+
+        // Reductions
+        registerBuiltin<&Interpreter::sum>("sum");
+        registerBuiltin<&Interpreter::minimum>("min");
+        registerBuiltin<&Interpreter::maximum>("max");
+        registerBuiltin<&Interpreter::mean>("mean");
+        registerBuiltin<&Interpreter::countIf>("count_if");
+        registerBuiltin<&Interpreter::dot>("dot");
+        registerBuiltin<&Interpreter::argmax>("argmax");
+
+        // Lazy sequences
+        registerBuiltin<&Interpreter::range>("range");
+        registerBuiltin<&Interpreter::map>("map");
+        registerBuiltin<&Interpreter::filter>("filter");
+        registerBuiltin<&Interpreter::take>("take");
+        registerBuiltin<&Interpreter::zip>("zip");
 
         // Array/object operations
-        registerBuiltin("get", 2, [this](const std::vector<Value> &args)
-                        { return get(args[0], args[1]); });
-
-        registerBuiltin("set", 3, [this](const std::vector<Value> &args)
-                        { return set(args[0], args[1], args[2]); });
+        registerBuiltin<&Interpreter::get>("get");
+        registerBuiltin<&Interpreter::set>("set");
 
-        registerBuiltin("array", 0, [this](const std::vector<Value> &args)
+        registerBuiltin("array", 0, [](void *, ValueSpan)
                         { return Value(std::vector<Value>{}); });
 
-        registerBuiltin("object", 0, [this](const std::vector<Value> &args)
-                        { return Value(std::unordered_map<std::string, Value>{}); });
+        registerBuiltin("object", 0, [](void *, ValueSpan)
+                        { return Value(Object()); });
+
+        // Tables
+        registerBuiltin<&Interpreter::toTable>("table");
+        registerBuiltin<&Interpreter::select>("select");
+        registerBuiltin<&Interpreter::groupBy>("group_by");
+        registerBuiltin<&Interpreter::aggregate>("aggregate");
     }
 
     void Interpreter::registerBuiltin(const std::string &name, int arity, BuiltinFunction func)
     {
-        namespace_[name] = FunctionEntry(name, arity, std::move(func));
-        arities_[name] = namespace_[name];
+        bindFunction(name, std::make_unique<FunctionEntry>(name, arity, std::move(func)));
     }
 
-    Value Interpreter::execute(const std::string &code)
+    void Interpreter::registerBuiltin(const std::string &name, int arity, FastFunction func, void *context)
     {
-        // Parse the code
-        Parser parser;
-        words_ = Parser::parseCode(code);
+        bindFunction(name, std::make_unique<FunctionEntry>(name, arity, func, context));
+    }
 
-        if (words_.empty())
+    void Interpreter::bindFunction(const std::string &name, std::unique_ptr<FunctionEntry> entry)
+    {
+        SymbolId symbol = symbols_.intern(name);
+        if (symbol >= functions_.size())
         {
-            return Value();
+            functions_.resize(symbol + 1);
         }
+        functions_[symbol] = std::move(entry);
+    }
+
+    const FunctionEntry *Interpreter::findFunction(std::string_view name) const
+    {
+        SymbolId symbol = symbols_.find(name);
+        return symbol < functions_.size() ? functions_[symbol].get() : nullptr;
+    }
+
+
+    Value Interpreter::execute(std::string code)
+    {
+        reset();
+        appendSource(std::move(code));
+
+        // A trailing incomplete phrase runs too, so its missing arguments
+        // are reported
+        return runPhrases(static_cast<int>(words_.size()));
+    }
+
+    Value Interpreter::execute(MappedFile script)
+    {
+        reset();
+        appendSource(std::move(script));
+        return runPhrases(static_cast<int>(words_.size()));
+    }
 
-        // Calculate phrase lengths
+    Value Interpreter::executeChunk(std::string code)
+    {
+        appendSource(std::move(code));
+
+        // Stop before a top-level phrase still waiting for arguments
+        int end = openPhrases_.empty() ? static_cast<int>(words_.size()) : openPhrases_.front().start;
+        return runPhrases(end);
+    }
+
+    void Interpreter::reset()
+    {
+        sources_.clear();
+        tokens_.clear();
+        words_.clear();
+        wordSymbols_.clear();
+        wordConstants_.clear();
+        constants_.clear();
+        symbolConstants_.clear();
         phraseLengths_.clear();
-        phraseLengths_.resize(words_.size());
-        calculatePhraseLengths();
+        openPhrases_.clear();
+        executedUntil_ = 0;
+        bytecode_.clear();
+        propertyCaches_.clear();
+        callSite_ = -1;
+    }
 
-        // Execute the main phrase
-        return wordExec(0, static_cast<int>(words_.size()) - 1);
+    void Interpreter::appendSource(std::string code)
+    {
+        // Each chunk keeps its own buffer so earlier word views stay valid
+        loadSource(std::get<std::string>(sources_.emplace_back(std::move(code))));
     }
 
-    void Interpreter::calculatePhraseLengths()
+    void Interpreter::appendSource(MappedFile script)
     {
-        for (int i = static_cast<int>(words_.size()) - 1; i >= 0; --i)
-        {
-            phraseLengths_[i] = phraseLength(i);
-        }
+        loadSource(std::get<MappedFile>(sources_.emplace_back(std::move(script))).text());
     }
 
-    int Interpreter::phraseLength(int start)
+    void Interpreter::loadSource(std::string_view source)
     {
-        if (start >= static_cast<int>(words_.size()))
+        std::vector<Token> tokens = Parser::tokenize(source);
+
+        int from = static_cast<int>(words_.size());
+        loadWords(tokens, source);
+        tokens_.insert(tokens_.end(), tokens.begin(), tokens.end());
+
+        phraseLengths_.resize(words_.size());
+        calculatePhraseLengths(from);
+    }
+
+    Value Interpreter::runPhrases(int end)
+    {
+        int start = executedUntil_;
+        if (start >= end)
+        {
+            return Value();
+        }
+
+        // Marked as run up front so a failing phrase is not retried
+        executedUntil_ = end;
+
+        // Under the Line and Block policies the run's output is passed on
+        // when it ends, also when it ends with an error
+        const bool flush = flushPolicy_ != FlushPolicy::Explicit;
+        Value result;
+        try
+        {
+            if (executionMode_ == ExecutionMode::Bytecode)
+            {
+                compile(start, end);
+                result = runBytecode();
+            }
+            else
+            {
+                // Execute each top-level phrase in turn, keeping the last result
+                for (; start < end; start += phraseLengths_[start])
+                {
+                    result = wordExec(start, start + phraseLengths_[start] - 1);
+                }
+            }
+        }
+        catch (...)
+        {
+            if (flush)
+            {
+                output_->flush();
+            }
+            throw;
+        }
+        if (flush)
         {
-            return 0;
+            output_->flush();
         }
+        return result;
+    }
 
-        const std::string &word = words_[start];
+    void Interpreter::loadWords(const std::vector<Token> &tokens, std::string_view source)
+    {
+        words_.reserve(words_.size() + tokens.size());
+        wordSymbols_.reserve(wordSymbols_.size() + tokens.size());
+        wordConstants_.reserve(wordConstants_.size() + tokens.size());
 
-        // Check if it's a function call
-        auto it = arities_.find(word);
-        if (it != arities_.end())
+        for (const Token &token : tokens)
         {
-            int arity = it->second.getArity();
-            int totalLength = 1; // The function name itself
+            std::string_view word = token.text(source);
+            words_.push_back(word);
+
+            if (auto literal = Parser::decodeLiteral(word))
+            {
+                wordSymbols_.push_back(SymbolTable::None);
+                wordConstants_.push_back(static_cast<std::uint32_t>(constants_.size()));
+                constants_.push_back(std::move(*literal));
+                continue;
+            }
+
+            SymbolId symbol = symbols_.intern(word);
+            wordSymbols_.push_back(symbol);
+
+            if (symbol < functions_.size() && functions_[symbol])
+            {
+                wordConstants_.push_back(SymbolTable::None);
+                continue;
+            }
 
-            // Add lengths of all parameters
-            int paramStart = start + 1;
-            for (int i = 0; i < arity && paramStart < static_cast<int>(words_.size()); ++i)
+            // Identifiers that are not functions evaluate to their own name;
+            // they get one constant per symbol rather than one per occurrence
+            if (symbol >= symbolConstants_.size())
+            {
+                symbolConstants_.resize(symbol + 1, SymbolTable::None);
+            }
+            if (symbolConstants_[symbol] == SymbolTable::None)
             {
-                int paramLength = phraseLength(paramStart);
-                totalLength += paramLength;
-                paramStart += paramLength;
+                symbolConstants_[symbol] = static_cast<std::uint32_t>(constants_.size());
+                constants_.push_back(Value(std::string(word)));
             }
+            wordConstants_.push_back(symbolConstants_[symbol]);
+        }
+    }
 
-            return totalLength;
+    void Interpreter::calculatePhraseLengths(int from)
+    {
+        // Single left-to-right pass. openPhrases_ holds the functions still
+        // collecting arguments; each completed phrase counts as one argument
+        // of the innermost of them, which may complete it in turn.
+        int size = static_cast<int>(words_.size());
+        for (int i = from; i < size; ++i)
+        {
+            const FunctionEntry *entry = functionAt(i);
+            int arity = entry ? entry->getArity() : 0;
+            if (arity > 0)
+            {
+                openPhrases_.push_back({i, arity});
+                continue;
+            }
+
+            phraseLengths_[i] = 1;
+            while (!openPhrases_.empty() && --openPhrases_.back().remaining == 0)
+            {
+                int start = openPhrases_.back().start;
+                phraseLengths_[start] = i - start + 1;
+                openPhrases_.pop_back();
+            }
         }
 
-        // For literals and variables, length is 1
-        return 1;
+        // Phrases still open run to the end of the words seen so far; they
+        // are recomputed when more words are appended
+        for (const OpenPhrase &open : openPhrases_)
+        {
+            phraseLengths_[open.start] = size - open.start;
+        }
     }
 
     Value Interpreter::wordExec(int start, int end)
@@ -175,113 +481,220 @@ namespace pangea
             return Value();
         }
 
-        const std::string &word = words_[start];
+        // Walk the words left to right. Functions wait on pendingCalls_
+        // until their arguments are on the operand stack, so nesting depth
+        // costs heap stack slots instead of C++ stack frames.
+        const std::size_t operandBase = operandStack_.size();
+        const std::size_t callBase = pendingCalls_.size();
 
-        // Check if it's a function call
-        auto it = namespace_.find(word);
-        if (it != namespace_.end())
+        try
         {
-            const FunctionEntry &entry = it->second;
-            int arity = entry.getArity();
-
-            // Collect arguments
-            std::vector<Value> args;
-            args.reserve(arity);
-
-            int paramStart = start + 1;
-            for (int i = 0; i < arity && paramStart <= end; ++i)
+            for (int i = start; i <= end; ++i)
             {
-                int paramLength = phraseLengths_[paramStart];
-                int paramEnd = paramStart + paramLength - 1;
+                const FunctionEntry *entry = functionAt(i);
+                if (entry && entry->isSpecialForm())
+                {
+                    // The form evaluates its argument phrases itself, so
+                    // the walk resumes after them
+                    operandStack_.push_back(callSpecialForm(*entry, i));
+                    i += phraseLengths_[i] - 1;
+                }
+                else if (entry && entry->getArity() > 0)
+                {
+                    if (pendingCalls_.size() >= maxDepth_)
+                    {
+                        throw std::runtime_error("Maximum nesting depth exceeded (" + std::to_string(maxDepth_) + ")");
+                    }
+                    pendingCalls_.push_back({i, entry->getArity()});
+                    continue;
+                }
+                else
+                {
+                    // Literals and unbound identifiers were decoded at parse time
+                    operandStack_.push_back(entry ? callWithStackArgs(*entry, 0, i) : constants_[wordConstants_[i]]);
+                }
 
-                if (paramEnd <= end)
+                // A finished value may complete the innermost pending call,
+                // whose result may complete the next one out
+                while (pendingCalls_.size() > callBase && --pendingCalls_.back().remaining == 0)
                 {
-                    args.push_back(wordExec(paramStart, paramEnd));
+                    const int site = pendingCalls_.back().start;
+                    const FunctionEntry &call = *functionAt(site);
+                    pendingCalls_.pop_back();
+                    Value result = callWithStackArgs(call, call.getArity(), site);
+                    operandStack_.push_back(std::move(result));
                 }
 
-                paramStart += paramLength;
+                if (pendingCalls_.size() == callBase)
+                {
+                    break;
+                }
             }
 
-            // Execute the function
-            return entry.invoke(args);
+            if (pendingCalls_.size() > callBase)
+            {
+                throw std::runtime_error("Missing arguments for function: " + std::string(words_[pendingCalls_.back().start]));
+            }
         }
+        catch (...)
+        {
+            operandStack_.resize(operandBase);
+            pendingCalls_.resize(callBase);
+            throw;
+        }
+
+        Value result = std::move(operandStack_.back());
+        operandStack_.resize(operandBase);
+        return result;
+    }
 
-        // Try to parse as a literal
-        return parseLiteral(word);
+    Value Interpreter::callWithStackArgs(const FunctionEntry &entry, int argc, int site)
+    {
+        // Arguments are passed as a view of the stack top, then popped
+        const std::size_t first = operandStack_.size() - argc;
+        callSite_ = site;
+        Value result = entry.invoke(ValueSpan(operandStack_.data() + first, argc));
+        operandStack_.resize(first);
+        return result;
     }
 
-    Value Interpreter::parseLiteral(const std::string &word)
+    Value Interpreter::callSpecialForm(const FunctionEntry &entry, int site)
     {
-        // Try to parse as number
-        try
+        // The argument phrases follow the function's word back to back
+        PhraseRef phrases[FunctionEntry::MaxSpecialArity];
+        const int arity = entry.getArity();
+        int next = site + 1;
+        for (int k = 0; k < arity; ++k)
         {
-            size_t pos;
-            double value = std::stod(word, &pos);
-            if (pos == word.length())
+            if (next >= static_cast<int>(words_.size()))
             {
-                return Value(value);
+                throw std::runtime_error("Missing arguments for function: " + std::string(words_[site]));
             }
-        }
-        catch (const std::exception &)
-        {
-            // Not a number, continue
+            phrases[k] = {next, phraseLengths_[next]};
+            next += phraseLengths_[next];
         }
 
-        // Try to parse as string (quoted)
-        if (word.length() >= 2 && word.front() == '"' && word.back() == '"')
+        // The form evaluates its phrases through evaluate(), so each level
+        // of nesting takes C++ stack frames and is bounded separately
+        const std::size_t limit = std::min(maxDepth_, MaxSpecialFormDepth);
+        if (specialDepth_ >= limit)
         {
-            return Value(word.substr(1, word.length() - 2));
+            throw std::runtime_error("Maximum nesting depth exceeded (" + std::to_string(limit) + ")");
         }
-
-        // Try to parse as boolean
-        if (word == "true")
+        struct DepthGuard
         {
-            return Value(true);
-        }
-        else if (word == "false")
-        {
-            return Value(false);
-        }
+            std::size_t &depth;
+            ~DepthGuard() { --depth; }
+        } guard{++specialDepth_};
 
-        // Default to string (unquoted identifier)
-        return Value(word);
+        callSite_ = site;
+        return entry.invokeSpecial(PhraseSpan(phrases, static_cast<std::size_t>(arity)));
     }
 
     // Built-in function implementations
-    Value Interpreter::plus(const Value &a, const Value &b)
+    Value Interpreter::plus(Value a, Value b)
     {
+        // Integers stay integers while the result fits; a sum of two inline
+        // integers cannot overflow int64, and Value promotes it if needed
+        if (a.isInteger() && b.isInteger())
+        {
+            return Value(a.asInteger() + b.asInteger());
+        }
         if (a.isNumber() && b.isNumber())
         {
             return Value(a.asNumber() + b.asNumber());
         }
-        else
+        if (isElementwise(a, b))
         {
-            return Value(a.toString() + b.toString());
+            return elementwise(VectorMath::Op::Add, std::move(a), std::move(b));
         }
+
+        // Strings are joined as ropes, so a chain of plus calls building up
+        // a long string does not copy the accumulated prefix every step
+        return Value::concat(a.isString() ? a : Value(a.toString()), b.isString() ? b : Value(b.toString()));
     }
 
-    Value Interpreter::minus(const Value &a, const Value &b)
+    Value Interpreter::minus(Value a, Value b)
     {
+        if (a.isInteger() && b.isInteger())
+        {
+            return Value(a.asInteger() - b.asInteger());
+        }
+        if (isElementwise(a, b))
+        {
+            return elementwise(VectorMath::Op::Subtract, std::move(a), std::move(b));
+        }
         return Value(a.asNumber() - b.asNumber());
     }
 
-    Value Interpreter::times(const Value &a, const Value &b)
+    Value Interpreter::times(Value a, Value b)
     {
+        if (a.isInteger() && b.isInteger())
+        {
+            std::int64_t product;
+            if (!__builtin_mul_overflow(a.asInteger(), b.asInteger(), &product))
+            {
+                return Value(product);
+            }
+        }
+        if (isElementwise(a, b))
+        {
+            return elementwise(VectorMath::Op::Multiply, std::move(a), std::move(b));
+        }
         return Value(a.asNumber() * b.asNumber());
     }
 
-    Value Interpreter::divide(const Value &a, const Value &b)
+    Value Interpreter::divide(Value a, Value b)
     {
+        // Element-wise division follows IEEE rules: x / 0 is infinite
+        if (isElementwise(a, b))
+        {
+            return elementwise(VectorMath::Op::Divide, std::move(a), std::move(b));
+        }
+
         double divisor = b.asNumber();
         if (divisor == 0.0)
         {
             throw std::runtime_error("Division by zero");
         }
+
+        // Exact integer quotients stay integers
+        if (a.isInteger() && b.isInteger() && a.asInteger() % b.asInteger() == 0)
+        {
+            return Value(a.asInteger() / b.asInteger());
+        }
         return Value(a.asNumber() / divisor);
     }
 
-    Value Interpreter::power(const Value &a, const Value &b)
+    Value Interpreter::power(Value a, Value b)
     {
+        if (isElementwise(a, b))
+        {
+            return elementwise(VectorMath::Op::Power, std::move(a), std::move(b));
+        }
+
+        // Non-negative integer powers by squaring, until the result overflows
+        if (a.isInteger() && b.isInteger() && b.asInteger() >= 0)
+        {
+            std::int64_t base = a.asInteger();
+            std::int64_t result = 1;
+            bool overflow = false;
+            for (std::int64_t exponent = b.asInteger(); exponent > 0 && !overflow; exponent >>= 1)
+            {
+                if (exponent & 1)
+                {
+                    overflow = __builtin_mul_overflow(result, base, &result);
+                }
+                if (exponent > 1 && !overflow)
+                {
+                    overflow = __builtin_mul_overflow(base, base, &base);
+                }
+            }
+            if (!overflow)
+            {
+                return Value(result);
+            }
+        }
         return Value(std::pow(a.asNumber(), b.asNumber()));
     }
 
@@ -290,38 +703,56 @@ namespace pangea
         return Value(a == b);
     }
 
-    Value Interpreter::less(const Value &a, const Value &b)
+    Value Interpreter::less(Value a, Value b)
     {
+        if (a.isInteger() && b.isInteger())
+        {
+            return Value(a.asInteger() < b.asInteger());
+        }
         if (a.isNumber() && b.isNumber())
         {
             return Value(a.asNumber() < b.asNumber());
         }
+        else if (isElementwise(a, b))
+        {
+            // A 1/0 mask, ready for sums and dot products
+            return elementwise(VectorMath::Op::Less, std::move(a), std::move(b));
+        }
         else
         {
             return Value(a.toString() < b.toString());
         }
     }
 
-    Value Interpreter::greater(const Value &a, const Value &b)
+    Value Interpreter::greater(Value a, Value b)
     {
+        if (a.isInteger() && b.isInteger())
+        {
+            return Value(a.asInteger() > b.asInteger());
+        }
         if (a.isNumber() && b.isNumber())
         {
             return Value(a.asNumber() > b.asNumber());
         }
+        else if (isElementwise(a, b))
+        {
+            return elementwise(VectorMath::Op::Greater, std::move(a), std::move(b));
+        }
         else
         {
             return Value(a.toString() > b.toString());
         }
     }
 
-    Value Interpreter::logicalAnd(const Value &a, const Value &b)
+    Value Interpreter::logicalAnd(PhraseRef a, PhraseRef b)
     {
-        return Value(a.asBoolean() && b.asBoolean());
+        // b is only evaluated when a does not decide the result
+        return Value(evaluate(a).asBoolean() && evaluate(b).asBoolean());
     }
 
-    Value Interpreter::logicalOr(const Value &a, const Value &b)
+    Value Interpreter::logicalOr(PhraseRef a, PhraseRef b)
     {
-        return Value(a.asBoolean() || b.asBoolean());
+        return Value(evaluate(a).asBoolean() || evaluate(b).asBoolean());
     }
 
     Value Interpreter::logicalNot(const Value &a)
@@ -331,63 +762,221 @@ namespace pangea
 
     void Interpreter::print(const Value &value)
     {
-        std::cout << value.toString();
+        // Values are streamed into the sink, never formatted as a whole
+        value.writeTo(*output_);
     }
 
     void Interpreter::println(const Value &value)
     {
-        std::cout << value.toString() << std::endl;
+        value.writeTo(*output_);
+        output_->put('\n');
+        if (flushPolicy_ == FlushPolicy::Line)
+        {
+            output_->flush();
+        }
     }
 
     Value Interpreter::input()
     {
-        std::string line;
-        std::getline(std::cin, line);
-        return Value(line);
+        // A prompt printed just before must be visible while waiting
+        output_->flush();
+        std::string_view line;
+        return input_->readLine(line) ? Value(std::string(line)) : Value();
+    }
+
+    Value Interpreter::lines()
+    {
+        return Value(Sequence::lines(input_));
+    }
+
+    Value Interpreter::readFile(const Value &path)
+    {
+        MappedFile file(path.asString());
+        return Value(std::string(file.text()));
     }
 
-    Value Interpreter::ifCondition(const Value &condition, const Value &thenValue, const Value &elseValue)
+    Value Interpreter::fileLines(const Value &path)
     {
-        return condition.asBoolean() ? thenValue : elseValue;
+        // Opened when the sequence is iterated, so a missing file is
+        // reported there, and each pass reads the file from the top
+        return Value(Sequence::fileLines(path.asString()));
     }
 
-    Value Interpreter::timesLoop(const Value &count, const Value &body)
+    Value Interpreter::fileSize(const Value &path)
     {
-        int times = static_cast<int>(count.asNumber());
+        return Value(static_cast<std::int64_t>(MappedFile::sizeOf(path.asString())));
+    }
+
+    Value Interpreter::readCsv(const Value &path)
+    {
+        return CsvReader::read(path.asString(), ',');
+    }
+
+    Value Interpreter::readTsv(const Value &path)
+    {
+        return CsvReader::read(path.asString(), '\t');
+    }
+
+    Value Interpreter::ifCondition(PhraseRef condition, PhraseRef thenBranch, PhraseRef elseBranch)
+    {
+        // Only the chosen branch is evaluated
+        return evaluate(condition).asBoolean() ? evaluate(thenBranch) : evaluate(elseBranch);
+    }
+
+    template <typename Next>
+    Value Interpreter::runLoop(PhraseRef body, Next &&next)
+    {
+        // The frame is reused for every iteration; it is looked up again
+        // after each body run since nested loops may move it
+        timesStack_.push(0);
+        eachStack_.emplace();
         Value result;
+        try
+        {
+            for (std::size_t i = 0; !eachStack_.top().stop && next(i, eachStack_.top()); ++i)
+            {
+                timesStack_.top() = i;
+                result = evaluate(body);
+            }
+        }
+        catch (...)
+        {
+            timesStack_.pop();
+            eachStack_.pop();
+            throw;
+        }
+        timesStack_.pop();
+        eachStack_.pop();
+        return result;
+    }
 
-        for (int i = 0; i < times; ++i)
+    Value Interpreter::timesLoop(PhraseRef count, PhraseRef body)
+    {
+        // The body phrase runs once per iteration; the result is its last value
+        // Whole counts are compared as integers; fractional ones round up
+        const Value times = evaluate(count);
+        std::size_t limit = 0;
+        if (times.isInteger())
         {
-            // In a real implementation, body would be executable code
-            // For now, just return the body value
-            result = body;
+            limit = times.asInteger() > 0 ? static_cast<std::size_t>(times.asInteger()) : 0;
         }
+        else if (double number = times.asNumber(); number > 0)
+        {
+            limit = static_cast<std::size_t>(std::min(std::ceil(number), static_cast<double>(Value::MaxInteger)));
+        }
+        return runLoop(body, [limit](std::size_t i, IterationFrame &frame)
+                       {
+            if (i >= limit)
+            {
+                return false;
+            }
+            frame.value = Value(static_cast<std::int64_t>(i));
+            return true; });
+    }
 
-        return result;
+    Value Interpreter::each(PhraseRef collection, PhraseRef body)
+    {
+        // The body phrase runs once per element, or per key of an object.
+        // `items` holds a reference, so a body updating the collection
+        // copies it instead of changing it under the loop
+        Value items = evaluate(collection);
+        if (items.isObject())
+        {
+            const Object &object = items.asObject();
+            return runLoop(body, [&object](std::size_t i, IterationFrame &frame)
+                           {
+                if (i >= object.size())
+                {
+                    return false;
+                }
+                frame.hasKey = true;
+                frame.key.assign(object.keyAt(static_cast<std::uint32_t>(i)));
+                frame.value = object.valueAt(static_cast<std::uint32_t>(i));
+                return true; });
+        }
+        if (items.isSequence())
+        {
+            Sequence::Cursor cursor(items.asSequence());
+            return runLoop(body, [&cursor](std::size_t, IterationFrame &frame)
+                           { return cursor.next(frame.value); });
+        }
+        if (items.isArray())
+        {
+            return runLoop(body, [&items](std::size_t i, IterationFrame &frame)
+                           {
+                if (i >= items.arraySize())
+                {
+                    return false;
+                }
+                // Column strings reuse the previous element's string
+                if (items.isStringArray())
+                {
+                    frame.value.assignString(items.asStringArray().at(i));
+                }
+                else
+                {
+                    frame.value = items.arrayAt(i);
+                }
+                return true; });
+        }
+        throw std::runtime_error("each expects an array, an object or a sequence");
+    }
+
+    IterationFrame &Interpreter::currentLoop(const char *name)
+    {
+        if (eachStack_.empty())
+        {
+            throw std::runtime_error(std::string(name) + " used outside of a loop");
+        }
+        return eachStack_.top();
     }
 
-    Value Interpreter::each(const Value &collection, const Value &body)
+    Value Interpreter::loopIndex()
     {
-        // Simplified implementation - in real version would iterate over collection
-        // and execute body for each element
-        return body;
+        currentLoop("index");
+        return Value(static_cast<std::int64_t>(timesStack_.top()));
+    }
+
+    Value Interpreter::loopKey()
+    {
+        // Objects are keyed by name, everything else by position
+        const IterationFrame &frame = currentLoop("key");
+        return frame.hasKey ? Value(frame.key) : Value(static_cast<std::int64_t>(timesStack_.top()));
+    }
+
+    Value Interpreter::loopValue()
+    {
+        return currentLoop("value").value;
+    }
+
+    void Interpreter::stopLoop()
+    {
+        currentLoop("stop").stop = true;
     }
 
     Value Interpreter::length(const Value &value)
     {
         if (value.isString())
         {
-            return Value(static_cast<double>(value.asString().length()));
+            return Value(static_cast<std::int64_t>(value.stringLength()));
         }
         else if (value.isArray())
         {
-            return Value(static_cast<double>(value.asArray().size()));
+            return Value(static_cast<std::int64_t>(value.arraySize()));
         }
         else if (value.isObject())
         {
-            return Value(static_cast<double>(value.asObject().size()));
+            return Value(static_cast<std::int64_t>(value.asObject().size()));
+        }
+        else if (value.isSequence())
+        {
+            return Value(static_cast<std::int64_t>(value.asSequence().size()));
         }
-        return Value(0.0);
+        else if (value.isTable())
+        {
+            return Value(static_cast<std::int64_t>(value.asTable().rowCount()));
+        }
+        return Value(std::int64_t(0));
     }
 
     Value Interpreter::type(const Value &value)
@@ -402,47 +991,466 @@ namespace pangea
             return Value("array");
         if (value.isObject())
             return Value("object");
+        if (value.isSequence())
+            return Value("sequence");
+        if (value.isTable())
+            return Value("table");
         return Value("unknown");
     }
 
-    Value Interpreter::toString(const Value &value)
+    Value Interpreter::toString(Value value)
+    {
+        return value.isString() ? std::move(value) : Value(value.toString());
+    }
+
+    Value Interpreter::join(const Value &collection, const Value &separator)
+    {
+        const std::size_t size = collection.arraySize();
+        const std::string &glue = separator.asString();
+
+        // Size the result first so the output is built in one allocation;
+        // only non-string items need a temporary conversion
+        std::vector<std::string> converted(size);
+        std::size_t total = size == 0 ? 0 : glue.size() * (size - 1);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            Value item = collection.arrayAt(i);
+            if (item.isString())
+            {
+                total += item.stringLength();
+            }
+            else
+            {
+                converted[i] = item.toString();
+                total += converted[i].size();
+            }
+        }
+
+        std::string result;
+        result.reserve(total);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (i > 0)
+            {
+                result += glue;
+            }
+            Value item = collection.arrayAt(i);
+            result += item.isString() ? item.asString() : converted[i];
+        }
+        return Value(std::move(result));
+    }
+
+    Value Interpreter::sum(const Value &collection)
+    {
+        NumberBlocks blocks(collection, "sum");
+        CompensatedSum total;
+        for (auto block = blocks.next(); !block.empty(); block = blocks.next())
+        {
+            total.add(VectorMath::sum(block.data(), block.size()));
+        }
+        return Value(total.value());
+    }
+
+    Value Interpreter::minimum(const Value &collection)
+    {
+        return extreme<false>(collection, "min");
+    }
+
+    Value Interpreter::maximum(const Value &collection)
+    {
+        return extreme<true>(collection, "max");
+    }
+
+    Value Interpreter::mean(const Value &collection)
+    {
+        NumberBlocks blocks(collection, "mean");
+        CompensatedSum total;
+        std::size_t count = 0;
+        for (auto block = blocks.next(); !block.empty(); block = blocks.next())
+        {
+            total.add(VectorMath::sum(block.data(), block.size()));
+            count += block.size();
+        }
+        return count == 0 ? Value() : Value(total.value() / static_cast<double>(count));
+    }
+
+    Value Interpreter::countIf(const Value &collection)
+    {
+        // Counts the truthy elements; for a packed array that is every
+        // element other than zero
+        if (collection.isNumberArray())
+        {
+            const auto &numbers = collection.asNumberArray();
+            return Value(static_cast<std::int64_t>(VectorMath::countNonZero(numbers.data(), numbers.size())));
+        }
+
+        Sequence::Cursor cursor(Sequence::of(collection));
+        std::size_t count = 0;
+        Value item;
+        while (cursor.next(item))
+        {
+            count += item.isTruthy();
+        }
+        return Value(static_cast<std::int64_t>(count));
+    }
+
+    Value Interpreter::dot(const Value &a, const Value &b)
+    {
+        if (a.isArray() && b.isArray() && a.arraySize() != b.arraySize())
+        {
+            throw std::runtime_error("Array lengths differ: " + std::to_string(a.arraySize()) + " and " + std::to_string(b.arraySize()));
+        }
+
+        // The inputs may come in blocks of different sizes, so each step
+        // takes what both have left
+        NumberBlocks blocksA(a, "dot"), blocksB(b, "dot");
+        std::span<const double> x = blocksA.next(), y = blocksB.next();
+        CompensatedSum total;
+        while (!x.empty() && !y.empty())
+        {
+            std::size_t n = std::min(x.size(), y.size());
+            total.add(VectorMath::dot(x.data(), y.data(), n));
+            x = x.subspan(n);
+            y = y.subspan(n);
+            x = x.empty() ? blocksA.next() : x;
+            y = y.empty() ? blocksB.next() : y;
+        }
+        if (!x.empty() || !y.empty())
+        {
+            throw std::runtime_error("dot expects inputs of equal length");
+        }
+        return Value(total.value());
+    }
+
+    Value Interpreter::argmax(const Value &collection)
+    {
+        NumberBlocks blocks(collection, "argmax");
+        std::size_t offset = 0;
+        std::size_t best = 0;
+        double bestValue = 0.0;
+        bool empty = true;
+        for (auto block = blocks.next(); !block.empty(); block = blocks.next())
+        {
+            std::size_t index = VectorMath::argmax(block.data(), block.size());
+            double candidate = block[index];
+            if (std::isnan(candidate))
+            {
+                return Value(static_cast<std::int64_t>(offset + index));
+            }
+            if (empty || candidate > bestValue)
+            {
+                best = offset + index;
+                bestValue = candidate;
+            }
+            empty = false;
+            offset += block.size();
+        }
+        return empty ? Value() : Value(static_cast<std::int64_t>(best));
+    }
+
+    const FunctionEntry &Interpreter::functionNamed(const Value &name)
+    {
+        const FunctionEntry *entry = findFunction(name.asString());
+        if (!entry)
+        {
+            throw std::runtime_error("Unknown function: " + name.asString());
+        }
+        return *entry;
+    }
+
+    Value Interpreter::range(const Value &start, const Value &end)
+    {
+        return Value(Sequence::range(start.asNumber(), end.asNumber()));
+    }
+
+    Value Interpreter::map(const Value &collection, const Value &function, Value operand)
+    {
+        return Value(Sequence::of(collection).map(functionNamed(function), std::move(operand)));
+    }
+
+    Value Interpreter::filter(const Value &collection, const Value &function, Value operand)
+    {
+        if (collection.isTable())
+        {
+            if (!operand.isObject())
+            {
+                throw std::runtime_error("filter on a table expects an object of column conditions");
+            }
+
+            // The builtin comparisons run as column kernels
+            const FunctionEntry &entry = functionNamed(function);
+            std::optional<VectorMath::Op> comparison;
+            if (entry.getFastFunction() == &MemberThunk<&Interpreter::less>::call)
+            {
+                comparison = VectorMath::Op::Less;
+            }
+            else if (entry.getFastFunction() == &MemberThunk<&Interpreter::greater>::call)
+            {
+                comparison = VectorMath::Op::Greater;
+            }
+            else if (entry.getFastFunction() == &MemberThunk<&Interpreter::equal>::call)
+            {
+                comparison = VectorMath::Op::Equal;
+            }
+            return Value(collection.asTable().filter(operand.asObject(), entry, comparison));
+        }
+        return Value(Sequence::of(collection).filter(functionNamed(function), std::move(operand)));
+    }
+
+    Value Interpreter::take(const Value &collection, const Value &count)
+    {
+        if (count.isInteger())
+        {
+            return Value(Sequence::of(collection).take(count.asInteger() > 0 ? static_cast<std::size_t>(count.asInteger()) : 0));
+        }
+        double limit = count.asNumber();
+        return Value(Sequence::of(collection).take(limit > 0 ? static_cast<std::size_t>(std::min(limit, static_cast<double>(Value::MaxInteger))) : 0));
+    }
+
+    Value Interpreter::zip(const Value &first, const Value &second)
     {
-        return Value(value.toString());
+        return Value(Sequence::zip(Sequence::of(first), Sequence::of(second)));
     }
 
     Value Interpreter::toNumber(const Value &value)
     {
-        return Value(value.asNumber());
+        if (value.isString())
+        {
+            // Same number rules as literals in source; null if not a number
+            auto literal = Parser::decodeLiteral(value.asString());
+            return literal && literal->isNumber() ? *literal : Value();
+        }
+        return value.isInteger() ? value : Value(value.asNumber());
+    }
+
+    Interpreter::PropertyCache *Interpreter::propertyCache()
+    {
+        if (callSite_ < 0)
+        {
+            return nullptr;
+        }
+        if (static_cast<std::size_t>(callSite_) >= propertyCaches_.size())
+        {
+            propertyCaches_.resize(words_.size() > static_cast<std::size_t>(callSite_) ? words_.size() : callSite_ + 1);
+        }
+        return &propertyCaches_[callSite_];
+    }
+
+    std::uint32_t Interpreter::findProperty(const Object &object, const Value &key)
+    {
+        PropertyCache *cache = propertyCache();
+        const auto &shape = object.getShape();
+        if (cache && shape && cache->shape == shape && !cache->next && cache->key.isIdentical(key))
+        {
+            return cache->slot;
+        }
+
+        std::uint32_t slot = object.findSlot(key.asString());
+        if (cache && shape && slot != Object::NotFound)
+        {
+            *cache = {key, shape, nullptr, slot};
+        }
+        return slot;
+    }
+
+    void Interpreter::storeProperty(Object &object, const Value &key, Value value)
+    {
+        PropertyCache *cache = propertyCache();
+        if (cache && object.getShape() && cache->shape == object.getShape() && cache->key.isIdentical(key))
+        {
+            if (cache->next)
+            {
+                object.append(cache->next, std::move(value));
+            }
+            else
+            {
+                object.valueAt(cache->slot) = std::move(value);
+            }
+            return;
+        }
+
+        std::shared_ptr<const Shape> before = object.getShape();
+        std::uint32_t slot = object.findSlot(key.asString());
+        if (slot != Object::NotFound)
+        {
+            object.valueAt(slot) = std::move(value);
+            if (cache && before)
+            {
+                *cache = {key, std::move(before), nullptr, slot};
+            }
+            return;
+        }
+
+        // Remember the transition too, so objects built alike skip the
+        // lookup when they gain the same key
+        slot = object.set(key.asString(), std::move(value));
+        if (cache && before && object.getShape())
+        {
+            *cache = {key, std::move(before), object.getShape(), slot};
+        }
     }
 
-    Value Interpreter::get(const Value &collection, const Value &key)
+    Value Interpreter::get(Value collection, const Value &key)
     {
+        // A collection nobody else references is about to be discarded, so
+        // the element can be moved out of it rather than copied
+        const bool owned = !collection.isShared();
+
         if (collection.isArray() && key.isNumber())
         {
-            const auto &arr = collection.asArray();
-            int index = static_cast<int>(key.asNumber());
-            if (index >= 0 && index < static_cast<int>(arr.size()))
+            // Integer keys index directly; doubles are truncated
+            const std::size_t size = collection.arraySize();
+            std::size_t index = size;
+            if (key.isInteger())
+            {
+                index = key.asInteger() >= 0 ? static_cast<std::size_t>(key.asInteger()) : size;
+            }
+            else if (double number = key.asNumber(); number >= 0 && number < static_cast<double>(size))
             {
-                return arr[index];
+                index = static_cast<std::size_t>(number);
+            }
+            if (index < size)
+            {
+                if (owned && !collection.isNumberArray() && !collection.isStringArray())
+                {
+                    return std::move(collection.asArrayMutable()[index]);
+                }
+                return collection.arrayAt(index);
+            }
+        }
+        else if (collection.isTable())
+        {
+            const Table &table = collection.asTable();
+            if (key.isString())
+            {
+                std::uint32_t index = table.findColumn(key.asString());
+                return index == Table::NotFound ? Value() : table.column(index);
+            }
+            if (key.isNumber() && key.asNumber() >= 0 && key.asNumber() < static_cast<double>(table.rowCount()))
+            {
+                return table.row(static_cast<std::size_t>(key.asNumber()));
             }
         }
         else if (collection.isObject() && key.isString())
         {
             const auto &obj = collection.asObject();
-            auto it = obj.find(key.asString());
-            if (it != obj.end())
+            std::uint32_t slot = findProperty(obj, key);
+            if (slot != Object::NotFound)
             {
-                return it->second;
+                return owned ? std::move(collection.asObjectMutable().valueAt(slot)) : obj.valueAt(slot);
             }
         }
         return Value();
     }
 
-    Value Interpreter::set(const Value &collection, const Value &key, const Value &value)
+    Value Interpreter::set(Value collection, const Value &key, Value value)
     {
-        // This would modify the collection in place in a real implementation
-        // For now, just return the value
-        return value;
+        // Returns the updated collection. The storage is only copied when
+        // another Value still shares it (copy-on-write)
+        if (collection.isArray() && key.isNumber())
+        {
+            std::size_t position;
+            if (key.isInteger() && key.asInteger() >= 0)
+            {
+                position = static_cast<std::size_t>(key.asInteger());
+            }
+            else
+            {
+                double index = key.asNumber();
+                if (index < 0 || index >= static_cast<double>(Value::MaxInteger) || index != std::floor(index))
+                {
+                    throw std::runtime_error("Invalid array index: " + key.toString());
+                }
+                position = static_cast<std::size_t>(index);
+            }
+
+            // Setting one past the end appends
+            if (position > collection.arraySize())
+            {
+                throw std::runtime_error("Array index out of range: " + key.toString());
+            }
+
+            // Numbers keep a packed array packed; anything else unpacks it
+            if (collection.isNumberArray() && value.isNumber())
+            {
+                auto &numbers = collection.asNumberArrayMutable();
+                if (position == numbers.size())
+                {
+                    numbers.push_back(value.asNumber());
+                }
+                else
+                {
+                    numbers[position] = value.asNumber();
+                }
+                return collection;
+            }
+
+            auto &arr = collection.asArrayMutable();
+            if (position == arr.size())
+            {
+                arr.push_back(std::move(value));
+            }
+            else
+            {
+                arr[position] = std::move(value);
+            }
+            return collection;
+        }
+        if (collection.isObject() && key.isString())
+        {
+            storeProperty(collection.asObjectMutable(), key, std::move(value));
+            return collection;
+        }
+        throw std::runtime_error("set expects an array with a number key or an object with a string key");
+    }
+
+    Value Interpreter::toTable(const Value &columns)
+    {
+        if (columns.isTable())
+        {
+            return columns;
+        }
+        if (!columns.isObject())
+        {
+            throw std::runtime_error("table expects an object of columns");
+        }
+        return Value(Table::fromColumns(columns.asObject()));
+    }
+
+    Value Interpreter::select(const Value &table, const Value &names)
+    {
+        // One column by name, or several from an array of names
+        std::vector<std::string> selected;
+        if (names.isString())
+        {
+            selected.push_back(names.asString());
+        }
+        else if (names.isArray())
+        {
+            for (std::size_t i = 0; i < names.arraySize(); ++i)
+            {
+                selected.push_back(names.arrayAt(i).asString());
+            }
+        }
+        else
+        {
+            throw std::runtime_error("select expects a column name or an array of them");
+        }
+        return Value(table.asTable().select(selected));
+    }
+
+    Value Interpreter::groupBy(const Value &table, const Value &column)
+    {
+        return Value(table.asTable().groupBy(column.asString()));
+    }
+
+    Value Interpreter::aggregate(const Value &table, const Value &spec)
+    {
+        if (!spec.isObject())
+        {
+            throw std::runtime_error("aggregate expects an object mapping columns to reductions");
+        }
+        return Value(table.asTable().aggregate(spec.asObject()));
     }
 
 } // namespace pangea
@@ -1,8 +1,7 @@
 #include "interpreter.hpp"
+#include "output_sink.hpp"
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 
 using namespace pangea;
 
@@ -18,22 +17,22 @@ void printUsage(const std::string &programName)
     std::cout << "If a file is provided, it will be executed and the result displayed.\n";
 }
 
-std::string readFile(const std::string &filename)
+// Results are streamed into the interpreter's output, after anything the
+// program printed, without building their text first
+void printResult(Interpreter &interpreter, const Value &result, std::string_view prefix = "")
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
-    {
-        throw std::runtime_error("Cannot open file: " + filename);
-    }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    OutputSink &out = interpreter.getOutput();
+    out.write(prefix);
+    result.writeTo(out);
+    out.put('\n');
+    interpreter.flushOutput();
 }
 
 void interactiveMode()
 {
+    // Every println shows up at once; prompts are flushed as written
     Interpreter interpreter;
+    interpreter.setFlushPolicy(Interpreter::FlushPolicy::Line);
     std::string line;
 
     std::cout << "Pangea C++ Interpreter\n";
@@ -41,12 +40,17 @@ void interactiveMode()
 
     while (true)
     {
-        std::cout << "pangea> ";
+        // A phrase still missing arguments continues on the next line
+        std::cout << (interpreter.hasPendingPhrase() ? "   ...> " : "pangea> ") << std::flush;
 
-        if (!std::getline(std::cin, line))
+        // Read through the interpreter's input, which `input` and `lines`
+        // share, so neither reads ahead of the other
+        std::string_view read;
+        if (!interpreter.getInput().readLine(read))
         {
             break; // EOF
         }
+        line.assign(read);
 
         if (line == "exit" || line == "quit")
         {
@@ -72,10 +76,10 @@ void interactiveMode()
 
         try
         {
-            Value result = interpreter.execute(line);
+            Value result = interpreter.executeChunk(line);
             if (!result.isNull())
             {
-                std::cout << "=> " << result.toString() << std::endl;
+                printResult(interpreter, result, "=> ");
             }
         }
         catch (const std::exception &e)
@@ -119,7 +123,7 @@ int main(int argc, char *argv[])
                     Value result = interpreter.execute(code);
                     if (!result.isNull())
                     {
-                        std::cout << result.toString() << std::endl;
+                        printResult(interpreter, result);
                     }
                     // Always exit after evaluation, no need for explicit "exit"
                     return 0;
@@ -140,13 +144,14 @@ int main(int argc, char *argv[])
             {
                 // This is a filename
                 hasFileArg = true;
-                std::string code = readFile(arg);
+                // The script is tokenized straight from its mapped pages
+                MappedFile script(arg);
                 Interpreter interpreter;
-                Value result = interpreter.execute(code);
+                Value result = interpreter.execute(std::move(script));
 
                 if (!result.isNull())
                 {
-                    std::cout << result.toString() << std::endl;
+                    printResult(interpreter, result);
                 }
                 return 0;
             }
@@ -0,0 +1,186 @@
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace pangea
+{
+
+    namespace
+    {
+        std::runtime_error fileError(const char *what, const std::string &path)
+        {
+            return std::runtime_error(std::string(what) + path + " (" + std::strerror(errno) + ")");
+        }
+
+        // Closes the descriptor however the constructor is left
+        struct Descriptor
+        {
+            int fd;
+
+            ~Descriptor()
+            {
+                if (fd >= 0)
+                {
+#if defined(_WIN32)
+                    ::_close(fd);
+#else
+                    ::close(fd);
+#endif
+                }
+            }
+        };
+    } // namespace
+
+    MappedFile::MappedFile(const std::string &path)
+    {
+#if defined(_WIN32)
+        Descriptor file{::_open(path.c_str(), _O_RDONLY | _O_BINARY)};
+#else
+        Descriptor file{::open(path.c_str(), O_RDONLY)};
+#endif
+        if (file.fd < 0)
+        {
+            throw fileError("Cannot open file: ", path);
+        }
+
+#if !defined(_WIN32)
+        struct stat info;
+        if (::fstat(file.fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            const auto size = static_cast<std::size_t>(info.st_size);
+            void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                // Scripts and data files are read front to back
+                ::madvise(mapping, size, MADV_SEQUENTIAL);
+                mapping_ = static_cast<const char *>(mapping);
+                size_ = size;
+                return;
+            }
+        }
+#endif
+
+        // Everything else is read to its end, in blocks
+        char block[64 * 1024];
+        while (true)
+        {
+#if defined(_WIN32)
+            int count = ::_read(file.fd, block, sizeof(block));
+#else
+            ssize_t count = ::read(file.fd, block, sizeof(block));
+#endif
+            if (count > 0)
+            {
+                contents_.append(block, static_cast<std::size_t>(count));
+            }
+            else if (count == 0)
+            {
+                break;
+            }
+            else if (errno != EINTR)
+            {
+                throw fileError("Cannot read file: ", path);
+            }
+        }
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : mapping_(other.mapping_), size_(other.size_), released_(other.released_), contents_(std::move(other.contents_))
+    {
+        other.mapping_ = nullptr;
+        other.size_ = 0;
+        other.released_ = 0;
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            mapping_ = other.mapping_;
+            size_ = other.size_;
+            released_ = other.released_;
+            contents_ = std::move(other.contents_);
+            other.mapping_ = nullptr;
+            other.size_ = 0;
+            other.released_ = 0;
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        unmap();
+    }
+
+    void MappedFile::unmap()
+    {
+#if !defined(_WIN32)
+        if (mapping_)
+        {
+            ::munmap(const_cast<char *>(mapping_), size_);
+        }
+#endif
+        mapping_ = nullptr;
+    }
+
+    void MappedFile::release(std::size_t offset)
+    {
+#if !defined(_WIN32)
+        if (!mapping_)
+        {
+            return;
+        }
+        static const auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t end = std::min(offset, size_) / pageSize * pageSize;
+        if (end > released_)
+        {
+            ::madvise(const_cast<char *>(mapping_) + released_, end - released_, MADV_DONTNEED);
+            released_ = end;
+        }
+#else
+        (void)offset;
+#endif
+    }
+
+    bool MappedFile::isMappable(const std::string &path)
+    {
+#if defined(_WIN32)
+        (void)path;
+        return false;
+#else
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0)
+        {
+            throw fileError("Cannot open file: ", path);
+        }
+        return S_ISREG(info.st_mode) && info.st_size > 0;
+#endif
+    }
+
+    std::uint64_t MappedFile::sizeOf(const std::string &path)
+    {
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0)
+        {
+            throw fileError("Cannot open file: ", path);
+        }
+        if (!S_ISREG(info.st_mode))
+        {
+            throw std::runtime_error("Not a regular file: " + path);
+        }
+        return static_cast<std::uint64_t>(info.st_size);
+    }
+
+} // namespace pangea
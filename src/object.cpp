@@ -0,0 +1,170 @@
+#include "object.hpp"
+
+namespace pangea
+{
+
+    const std::shared_ptr<const Shape> &Shape::empty()
+    {
+        static const std::shared_ptr<const Shape> root = []
+        {
+            auto shape = std::make_shared<Shape>();
+            shape->keys_ = std::make_shared<std::deque<std::string>>();
+            return shape;
+        }();
+        return root;
+    }
+
+    Shape::~Shape()
+    {
+        // The parent's entry for this shape expired as it was released
+        if (parent_)
+        {
+            auto it = parent_->transitions_.find(keyAt(static_cast<std::uint32_t>(size_ - 1)));
+            if (it != parent_->transitions_.end() && it->second.expired())
+            {
+                parent_->transitions_.erase(it);
+            }
+        }
+    }
+
+    std::uint32_t Shape::find(std::string_view key) const
+    {
+        // Shapes are capped at Object::MaxShapeSize keys, so a scan is
+        // cheaper than maintaining a hash index per shape
+        for (std::uint32_t slot = 0; slot < size_; ++slot)
+        {
+            if ((*keys_)[slot] == key)
+            {
+                return slot;
+            }
+        }
+        return NotFound;
+    }
+
+    std::shared_ptr<const Shape> Shape::withKey(std::string_view key) const
+    {
+        auto it = transitions_.find(key);
+        if (it != transitions_.end())
+        {
+            if (auto existing = it->second.lock())
+            {
+                return existing;
+            }
+        }
+
+        // Share the key storage when the key already follows this shape's
+        // keys there (a freed child put it) or nothing does yet; otherwise
+        // another child did, and the prefix is copied
+        auto next = std::make_shared<Shape>();
+        if (keys_->size() == size_)
+        {
+            keys_->emplace_back(key);
+            next->keys_ = keys_;
+        }
+        else if ((*keys_)[size_] == key)
+        {
+            next->keys_ = keys_;
+        }
+        else
+        {
+            next->keys_ = std::make_shared<std::deque<std::string>>(keys_->begin(), keys_->begin() + static_cast<std::ptrdiff_t>(size_));
+            next->keys_->emplace_back(key);
+        }
+        next->size_ = size_ + 1;
+        next->parent_ = shared_from_this();
+
+        if (it != transitions_.end())
+        {
+            it->second = next;
+        }
+        else
+        {
+            transitions_.emplace(std::string(key), next);
+        }
+        return next;
+    }
+
+    std::uint32_t Object::findSlot(std::string_view key) const
+    {
+        if (shape_)
+        {
+            return shape_->find(key);
+        }
+        return dictionary_.find(key);
+    }
+
+    const Value *Object::find(std::string_view key) const
+    {
+        std::uint32_t slot = findSlot(key);
+        return slot != NotFound ? &valueAt(slot) : nullptr;
+    }
+
+    std::uint32_t Object::set(std::string_view key, Value value)
+    {
+        if (shape_ && slots_.size() >= MaxShapeSize && shape_->find(key) == NotFound)
+        {
+            toDictionary();
+        }
+
+        if (!shape_)
+        {
+            std::uint32_t slot = dictionary_.insert(key, Value()).first;
+            dictionary_.valueAt(slot) = std::move(value);
+            return slot;
+        }
+
+        std::uint32_t slot = shape_->find(key);
+        if (slot != NotFound)
+        {
+            slots_[slot] = std::move(value);
+            return slot;
+        }
+
+        shape_ = shape_->withKey(key);
+        slots_.push_back(std::move(value));
+        return static_cast<std::uint32_t>(slots_.size() - 1);
+    }
+
+    void Object::append(std::shared_ptr<const Shape> shape, Value value)
+    {
+        shape_ = std::move(shape);
+        slots_.push_back(std::move(value));
+    }
+
+    void Object::toDictionary()
+    {
+        dictionary_.reserve(slots_.size() * 2);
+        for (std::uint32_t slot = 0; slot < slots_.size(); ++slot)
+        {
+            dictionary_.insert(shape_->keyAt(slot), std::move(slots_[slot]));
+        }
+        slots_.clear();
+        slots_.shrink_to_fit();
+        shape_.reset();
+    }
+
+    bool Object::operator==(const Object &other) const
+    {
+        if (size() != other.size())
+        {
+            return false;
+        }
+
+        // Same shape means same keys in the same slots
+        if (shape_ && shape_ == other.shape_)
+        {
+            return slots_ == other.slots_;
+        }
+
+        for (std::uint32_t slot = 0; slot < size(); ++slot)
+        {
+            const Value *value = other.find(keyAt(slot));
+            if (!value || *value != valueAt(slot))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace pangea
@@ -0,0 +1,78 @@
+#include "output_sink.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace pangea
+{
+
+    void OutputSink::writeSlow(std::string_view text)
+    {
+        drain();
+
+        // Pieces larger than the buffer bypass it
+        if (text.size() >= capacity_)
+        {
+            consume(text);
+            return;
+        }
+        std::memcpy(buffer_.get(), text.data(), text.size());
+        used_ = text.size();
+    }
+
+    FileSink::~FileSink()
+    {
+        // A failing destination must not throw out of a destructor
+        try
+        {
+            drain();
+        }
+        catch (...)
+        {
+        }
+        if (owned_)
+        {
+#if defined(_WIN32)
+            ::_close(descriptor_);
+#else
+            ::close(descriptor_);
+#endif
+        }
+    }
+
+    void FileSink::consume(std::string_view bytes)
+    {
+        if (descriptor_ == 1)
+        {
+            std::cout.flush();
+        }
+
+        // Writes may be partial or interrupted; keep going until every
+        // byte is out
+        while (!bytes.empty())
+        {
+#if defined(_WIN32)
+            int count = ::_write(descriptor_, bytes.data(), static_cast<unsigned>(std::min<std::size_t>(bytes.size(), INT_MAX)));
+#else
+            ssize_t count = ::write(descriptor_, bytes.data(), bytes.size());
+#endif
+            if (count >= 0)
+            {
+                bytes.remove_prefix(static_cast<std::size_t>(count));
+            }
+            else if (errno != EINTR)
+            {
+                throw std::runtime_error(std::string("Cannot write output: ") + std::strerror(errno));
+            }
+        }
+    }
+
+} // namespace pangea
@@ -1,81 +1,72 @@
 #include "parser.hpp"
-#include <sstream>
+#include "scanner.hpp"
+#include <charconv>
 #include <iostream>
-#include <algorithm>
+#include <stdexcept>
 
 namespace pangea
 {
 
-    std::vector<std::string> Parser::parseCode(const std::string &code)
+    namespace
     {
-        std::vector<std::string> result;
-
-        // Remove comments line by line
-        std::istringstream iss(code);
-        std::string line;
-        std::ostringstream cleanCode;
-
-        while (std::getline(iss, line))
+        // Same classification as std::isspace in the "C" locale
+        inline bool isSpace(char c)
         {
-            std::string processedLine = removeComments(line);
-            // Trim whitespace
-            processedLine.erase(0, processedLine.find_first_not_of(" \t\r\n"));
-            processedLine.erase(processedLine.find_last_not_of(" \t\r\n") + 1);
-
-            if (!processedLine.empty())
-            {
-                cleanCode << processedLine << " ";
-            }
+            return c == ' ' || (c >= '\t' && c <= '\r');
         }
+    } // namespace
 
-        std::string cleanCodeStr = cleanCode.str();
-        // Trim final result
-        cleanCodeStr.erase(0, cleanCodeStr.find_first_not_of(" \t\r\n"));
-        cleanCodeStr.erase(cleanCodeStr.find_last_not_of(" \t\r\n") + 1);
-
-        if (cleanCodeStr.empty())
+    std::vector<std::string> Parser::parseCode(const std::string &code)
+    {
+        std::vector<std::string> result;
+        for (const Token &token : tokenize(code))
         {
-            return result;
+            result.emplace_back(token.text(code));
         }
-
-        // Smart tokenization that preserves quoted strings
-        auto tokens = tokenizeWithStringPreservation(cleanCodeStr);
-        result.insert(result.end(), tokens.begin(), tokens.end());
-
         return result;
     }
 
-    Value Parser::parseValue(const std::string &text)
+    std::optional<Value> Parser::decodeLiteral(std::string_view text)
     {
         if (text.empty())
         {
-            return Value();
+            return std::nullopt;
         }
 
-        // Try to parse as number
-        try
+        // Numbers: [+-][.]digit..., decoded without exceptions
+        std::size_t digit = (text.front() == '+' || text.front() == '-') ? 1 : 0;
+        if (digit < text.size() && text[digit] == '.')
         {
-            if (text.find('.') != std::string::npos)
+            ++digit;
+        }
+        if (digit < text.size() && text[digit] >= '0' && text[digit] <= '9')
+        {
+            // from_chars accepts '-' but not '+'
+            const char *first = text.data() + (text.front() == '+' ? 1 : 0);
+            const char *last = text.data() + text.size();
+
+            // Plain digits are integers; "-0" stays a double to keep its sign
+            std::int64_t integer = 0;
+            auto [integerEnd, integerError] = std::from_chars(first, last, integer);
+            if (integerError == std::errc() && integerEnd == last && (integer != 0 || text.front() != '-'))
             {
-                return Value(std::stod(text));
+                return Value(integer);
             }
-            else
+
+            double number = 0.0;
+            auto [end, error] = std::from_chars(first, last, number);
+            if (error == std::errc() && end == last)
             {
-                return Value(static_cast<double>(std::stoll(text)));
+                return Value(number);
             }
-        }
-        catch (const std::exception &)
-        {
-            // Not a number, continue
+            return std::nullopt;
         }
 
-        // Try to parse as string literal
-        if (text.length() >= 2 && text.front() == '"' && text.back() == '"')
+        if (isString(text))
         {
-            return Value(text.substr(1, text.length() - 2));
+            return Value(std::string(text.substr(1, text.length() - 2)));
         }
 
-        // Try to parse as boolean or null
         if (text == "true")
             return Value(true);
         if (text == "false")
@@ -83,126 +74,114 @@ namespace pangea
         if (text == "null")
             return Value();
 
-        return Value(); // Return null value if not a literal
+        return std::nullopt;
     }
 
-    bool Parser::isString(const std::string &text)
+    Value Parser::parseValue(std::string_view text)
+    {
+        return decodeLiteral(text).value_or(Value());
+    }
+
+    bool Parser::isString(std::string_view text)
     {
         return text.length() >= 2 && text.front() == '"' && text.back() == '"';
     }
 
-    std::vector<std::string> Parser::tokenizeWithStringPreservation(const std::string &code)
+    std::vector<Token> Parser::tokenize(std::string_view source)
     {
-        std::vector<std::string> tokens;
-        std::string currentToken;
-        bool inQuotes = false;
+        if (source.size() > UINT32_MAX)
+        {
+            throw std::runtime_error("Source code too large");
+        }
+
+        std::vector<Token> tokens;
+        const std::size_t size = source.size();
+        std::size_t i = 0;
+        std::size_t lineStart = 0;
+        std::uint32_t line = 1;
 
-        for (size_t i = 0; i < code.length(); ++i)
+        auto emit = [&](std::size_t start, std::uint32_t startLine, std::size_t startLineOffset)
         {
-            char c = code[i];
+            tokens.push_back({static_cast<std::uint32_t>(start),
+                              static_cast<std::uint32_t>(i - start),
+                              startLine,
+                              static_cast<std::uint32_t>(start - startLineOffset + 1)});
+        };
 
-            if (c == '"')
-            {
-                if (!inQuotes)
-                {
-                    // Starting a string
-                    if (!currentToken.empty())
-                    {
-                        tokens.push_back(currentToken);
-                        currentToken.clear();
-                    }
-                    inQuotes = true;
-                    currentToken += c;
-                }
-                else
-                {
-                    // Ending a string
-                    currentToken += c;
-                    tokens.push_back(currentToken);
-                    currentToken.clear();
-                    inQuotes = false;
-                }
-            }
-            else if (inQuotes)
-            {
-                // Inside a string literal - preserve all characters including spaces
-                currentToken += c;
-            }
-            else if (std::isspace(c))
-            {
-                if (!currentToken.empty())
-                {
-                    tokens.push_back(currentToken);
-                    currentToken.clear();
-                }
-            }
-            else
-            {
-                currentToken += c;
-            }
-        }
+        const char *data = source.data();
 
-        // Handle any remaining token
-        if (!currentToken.empty())
+        while (i < size)
         {
-            if (inQuotes)
+            i = Scanner::skipBlanks(data, i, size);
+            if (i >= size)
             {
-                std::cerr << "ERROR: Unterminated string literal: " << currentToken << std::endl;
-                std::cerr << "       Missing closing quote character." << std::endl;
+                break;
             }
-            tokens.push_back(currentToken);
-        }
 
-        return tokens;
-    }
-
-    std::string Parser::removeComments(const std::string &line)
-    {
-        std::string result;
-        bool inString = false;
-        bool escaped = false;
+            char c = source[i];
 
-        for (size_t i = 0; i < line.length(); ++i)
-        {
-            char c = line[i];
-
-            if (escaped)
+            if (c == '\n')
             {
-                result += c;
-                escaped = false;
+                ++line;
+                lineStart = ++i;
                 continue;
             }
 
-            if (c == '\\')
+            if (c == '#' && (i == 0 || isSpace(source[i - 1])))
             {
-                escaped = true;
-                result += c;
+                // Line comment: skip to the end of the line
+                i = Scanner::findLineEnd(data, i, size);
                 continue;
             }
 
+            const std::size_t start = i;
+            const std::size_t startLineOffset = lineStart;
+            const std::uint32_t startLine = line;
+
             if (c == '"')
             {
-                inString = !inString;
-                result += c;
-                continue;
-            }
+                // String literal: runs to the next unescaped quote
+                ++i;
+                bool terminated = false;
+                while ((i = Scanner::findStringEnd(data, i, size)) < size)
+                {
+                    char s = source[i++];
+                    if (s == '"')
+                    {
+                        terminated = true;
+                        break;
+                    }
+                    if (s == '\\' && i < size && source[i] != '\n')
+                    {
+                        ++i;
+                    }
+                    else if (s == '\n')
+                    {
+                        ++line;
+                        lineStart = i;
+                    }
+                }
 
-            if (!inString && c == '#')
-            {
-                // Check if # is preceded by non-whitespace (function arity)
-                if (i > 0 && !std::isspace(line[i - 1]))
+                if (!terminated)
                 {
-                    result += c;
-                    continue;
+                    std::cerr << "ERROR: Unterminated string literal: " << source.substr(start) << std::endl;
+                    std::cerr << "       Missing closing quote character." << std::endl;
                 }
-                // This is a comment, stop processing
-                break;
+
+                emit(start, startLine, startLineOffset);
+                continue;
             }
 
-            result += c;
+            // Bare word: runs to whitespace or the start of a string; a
+            // backslash keeps the non-blank character after it in the word
+            while ((i = Scanner::findWordEnd(data, i, size)) < size && source[i] == '\\')
+            {
+                i += (i + 1 < size && !isSpace(source[i + 1])) ? 2 : 1;
+            }
+            emit(start, startLine, startLineOffset);
         }
 
-        return result;
+        return tokens;
     }
 
 } // namespace pangea
@@ -0,0 +1,352 @@
+#include "scanner.hpp"
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define PANGEA_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace pangea
+{
+
+    namespace
+    {
+        using ScanFunction = std::size_t (*)(const char *, std::size_t, std::size_t);
+        using StopsFunction = std::uint64_t (*)(const char *, char);
+
+        struct Kernels
+        {
+            Scanner::Backend backend;
+            ScanFunction skipBlanks;
+            ScanFunction findWordEnd;
+            ScanFunction findStringEnd;
+            StopsFunction fieldStops;
+        };
+
+        // Blanks are whitespace other than the line feed
+        inline bool isBlank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+        }
+
+        inline bool isWordEnd(char c)
+        {
+            return c == ' ' || (c >= '\t' && c <= '\r') || c == '"' || c == '\\';
+        }
+
+        inline bool isStringStop(char c)
+        {
+            return c == '"' || c == '\\' || c == '\n';
+        }
+
+        // Scalar reference backend, also used for the tails of vector scans
+        std::size_t skipBlanksScalar(const char *data, std::size_t pos, std::size_t size)
+        {
+            while (pos < size && isBlank(data[pos]))
+            {
+                ++pos;
+            }
+            return pos;
+        }
+
+        std::size_t findWordEndScalar(const char *data, std::size_t pos, std::size_t size)
+        {
+            while (pos < size && !isWordEnd(data[pos]))
+            {
+                ++pos;
+            }
+            return pos;
+        }
+
+        std::size_t findStringEndScalar(const char *data, std::size_t pos, std::size_t size)
+        {
+            while (pos < size && !isStringStop(data[pos]))
+            {
+                ++pos;
+            }
+            return pos;
+        }
+
+        std::uint64_t fieldStopsScalar(const char *block, char delimiter)
+        {
+            std::uint64_t stops = 0;
+            for (std::size_t i = 0; i < Scanner::FieldBlockSize; ++i)
+            {
+                char c = block[i];
+                stops |= static_cast<std::uint64_t>(c == delimiter || c == '"' || c == '\n') << i;
+            }
+            return stops;
+        }
+
+        constexpr Kernels scalarKernels{Scanner::Backend::Scalar, skipBlanksScalar, findWordEndScalar, findStringEndScalar, fieldStopsScalar};
+
+#ifdef PANGEA_SCANNER_X86
+        // Lanes holding '\t'..'\r' or ' ': (byte - 9) <= 4 unsigned, or == ' '
+        inline __m128i whitespaceMask128(__m128i bytes)
+        {
+            __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+            __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+            return _mm_or_si128(control, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+        }
+
+        std::size_t skipBlanksSSE2(const char *data, std::size_t pos, std::size_t size)
+        {
+            const __m128i newline = _mm_set1_epi8('\n');
+            for (; pos + 16 <= size; pos += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+                __m128i blanks = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, newline), whitespaceMask128(bytes));
+                unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(blanks)) & 0xFFFFu;
+                if (mask != 0)
+                {
+                    return pos + __builtin_ctz(mask);
+                }
+            }
+            return skipBlanksScalar(data, pos, size);
+        }
+
+        std::size_t findWordEndSSE2(const char *data, std::size_t pos, std::size_t size)
+        {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            for (; pos + 16 <= size; pos += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+                __m128i stops = _mm_or_si128(whitespaceMask128(bytes),
+                                             _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(stops));
+                if (mask != 0)
+                {
+                    return pos + __builtin_ctz(mask);
+                }
+            }
+            return findWordEndScalar(data, pos, size);
+        }
+
+        std::size_t findStringEndSSE2(const char *data, std::size_t pos, std::size_t size)
+        {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i newline = _mm_set1_epi8('\n');
+            for (; pos + 16 <= size; pos += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+                __m128i stops = _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                                             _mm_or_si128(_mm_cmpeq_epi8(bytes, backslash), _mm_cmpeq_epi8(bytes, newline)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(stops));
+                if (mask != 0)
+                {
+                    return pos + __builtin_ctz(mask);
+                }
+            }
+            return findStringEndScalar(data, pos, size);
+        }
+
+        std::uint64_t fieldStopsSSE2(const char *block, char delimiter)
+        {
+            const __m128i separator = _mm_set1_epi8(delimiter);
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i newline = _mm_set1_epi8('\n');
+            std::uint64_t stops = 0;
+            for (std::size_t i = 0; i < Scanner::FieldBlockSize; i += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+                __m128i found = _mm_or_si128(_mm_cmpeq_epi8(bytes, separator),
+                                             _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, newline)));
+                stops |= static_cast<std::uint64_t>(_mm_movemask_epi8(found)) << i;
+            }
+            return stops;
+        }
+
+        constexpr Kernels sse2Kernels{Scanner::Backend::SSE2, skipBlanksSSE2, findWordEndSSE2, findStringEndSSE2, fieldStopsSSE2};
+
+        __attribute__((target("avx2"))) inline __m256i whitespaceMask256(__m256i bytes)
+        {
+            __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+            __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+            return _mm256_or_si256(control, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')));
+        }
+
+        __attribute__((target("avx2"))) std::size_t skipBlanksAVX2(const char *data, std::size_t pos, std::size_t size)
+        {
+            const __m256i newline = _mm256_set1_epi8('\n');
+            for (; pos + 32 <= size; pos += 32)
+            {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+                __m256i blanks = _mm256_andnot_si256(_mm256_cmpeq_epi8(bytes, newline), whitespaceMask256(bytes));
+                unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(blanks));
+                if (mask != 0)
+                {
+                    return pos + __builtin_ctz(mask);
+                }
+            }
+            return skipBlanksSSE2(data, pos, size);
+        }
+
+        __attribute__((target("avx2"))) std::size_t findWordEndAVX2(const char *data, std::size_t pos, std::size_t size)
+        {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            for (; pos + 32 <= size; pos += 32)
+            {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+                __m256i stops = _mm256_or_si256(whitespaceMask256(bytes),
+                                                _mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote), _mm256_cmpeq_epi8(bytes, backslash)));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(stops));
+                if (mask != 0)
+                {
+                    return pos + __builtin_ctz(mask);
+                }
+            }
+            return findWordEndSSE2(data, pos, size);
+        }
+
+        __attribute__((target("avx2"))) std::size_t findStringEndAVX2(const char *data, std::size_t pos, std::size_t size)
+        {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i newline = _mm256_set1_epi8('\n');
+            for (; pos + 32 <= size; pos += 32)
+            {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+                __m256i stops = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote),
+                                                _mm256_or_si256(_mm256_cmpeq_epi8(bytes, backslash), _mm256_cmpeq_epi8(bytes, newline)));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(stops));
+                if (mask != 0)
+                {
+                    return pos + __builtin_ctz(mask);
+                }
+            }
+            return findStringEndSSE2(data, pos, size);
+        }
+
+        __attribute__((target("avx2"))) std::uint64_t fieldStopsAVX2(const char *block, char delimiter)
+        {
+            const __m256i separator = _mm256_set1_epi8(delimiter);
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i newline = _mm256_set1_epi8('\n');
+            std::uint64_t stops = 0;
+            for (std::size_t i = 0; i < Scanner::FieldBlockSize; i += 32)
+            {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+                __m256i found = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, separator),
+                                                _mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote), _mm256_cmpeq_epi8(bytes, newline)));
+                stops |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(found))) << i;
+            }
+            return stops;
+        }
+
+        constexpr Kernels avx2Kernels{Scanner::Backend::AVX2, skipBlanksAVX2, findWordEndAVX2, findStringEndAVX2, fieldStopsAVX2};
+#endif
+
+        const Kernels *kernelsFor(Scanner::Backend backend)
+        {
+            switch (backend)
+            {
+#ifdef PANGEA_SCANNER_X86
+            case Scanner::Backend::SSE2:
+                return &sse2Kernels;
+            case Scanner::Backend::AVX2:
+                return &avx2Kernels;
+#endif
+            case Scanner::Backend::Scalar:
+            default:
+                return &scalarKernels;
+            }
+        }
+
+        const Kernels *&activeKernels()
+        {
+            static const Kernels *active = kernelsFor(Scanner::getBestBackend());
+            return active;
+        }
+    } // namespace
+
+    std::size_t Scanner::skipBlanks(const char *data, std::size_t pos, std::size_t size)
+    {
+        return activeKernels()->skipBlanks(data, pos, size);
+    }
+
+    std::size_t Scanner::findWordEnd(const char *data, std::size_t pos, std::size_t size)
+    {
+        return activeKernels()->findWordEnd(data, pos, size);
+    }
+
+    std::size_t Scanner::findStringEnd(const char *data, std::size_t pos, std::size_t size)
+    {
+        return activeKernels()->findStringEnd(data, pos, size);
+    }
+
+    std::uint64_t Scanner::fieldStops(const char *block, char delimiter)
+    {
+        return activeKernels()->fieldStops(block, delimiter);
+    }
+
+    std::size_t Scanner::findLineEnd(const char *data, std::size_t pos, std::size_t size)
+    {
+        // memchr is already vectorized by the C library
+        const void *found = pos < size ? std::memchr(data + pos, '\n', size - pos) : nullptr;
+        return found ? static_cast<std::size_t>(static_cast<const char *>(found) - data) : size;
+    }
+
+    Scanner::Backend Scanner::getBackend()
+    {
+        return activeKernels()->backend;
+    }
+
+    void Scanner::setBackend(Backend backend)
+    {
+        if (!isSupported(backend))
+        {
+            throw std::runtime_error("Scanner backend not supported on this CPU: " + getBackendName(backend));
+        }
+        activeKernels() = kernelsFor(backend);
+    }
+
+    bool Scanner::isSupported(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Scalar:
+            return true;
+#ifdef PANGEA_SCANNER_X86
+        case Backend::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Backend::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+        }
+    }
+
+    Scanner::Backend Scanner::getBestBackend()
+    {
+        if (isSupported(Backend::AVX2))
+        {
+            return Backend::AVX2;
+        }
+        if (isSupported(Backend::SSE2))
+        {
+            return Backend::SSE2;
+        }
+        return Backend::Scalar;
+    }
+
+    std::string Scanner::getBackendName(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Scalar:
+            return "scalar";
+        case Backend::SSE2:
+            return "sse2";
+        case Backend::AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+        }
+    }
+
+} // namespace pangea
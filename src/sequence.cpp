@@ -0,0 +1,299 @@
+#include "sequence.hpp"
+#include "function_entry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pangea
+{
+
+    struct Sequence::Node
+    {
+        enum class Kind
+        {
+            Range,
+            Array,
+            Lines,
+            Map,
+            Filter,
+            Take,
+            Zip
+        };
+
+        Kind kind;
+        std::shared_ptr<const Node> input;  // Map, Filter, Take, Zip
+        std::shared_ptr<const Node> second; // Zip
+        Value value;                        // The array, or the function's operand
+        const FunctionEntry *function = nullptr;
+        std::shared_ptr<InputSource> source; // Lines, unless read from a file
+        std::string path;                    // Lines of a file
+        double start = 0.0;
+        bool integral = false; // Range elements are integers
+        std::size_t count = 0; // Range length, or Take limit
+    };
+
+    namespace
+    {
+        const FunctionEntry &checkFunction(const FunctionEntry &function, const char *name)
+        {
+            if (function.isSpecialForm() || (function.getArity() != 1 && function.getArity() != 2))
+            {
+                throw std::runtime_error(std::string(name) + " expects a function of one or two arguments");
+            }
+            return function;
+        }
+    } // namespace
+
+    Sequence Sequence::range(double start, double end)
+    {
+        if (!std::isfinite(start) || !std::isfinite(end))
+        {
+            throw std::runtime_error("range expects finite bounds");
+        }
+
+        // The count is clamped like take's, so a span too large for an
+        // integer (or a double overflowing to infinity) converts safely
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Range;
+        node->start = start;
+        const double span = end > start ? std::ceil(end - start) : 0.0;
+        node->count = static_cast<std::size_t>(std::min(span, static_cast<double>(Value::MaxInteger)));
+        node->integral = start == std::floor(start) && std::abs(start) + static_cast<double>(node->count) <= static_cast<double>(Value::MaxInteger);
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::of(const Value &collection)
+    {
+        if (collection.isSequence())
+        {
+            return collection.asSequence();
+        }
+        if (!collection.isArray())
+        {
+            throw std::runtime_error("Expected an array or a sequence");
+        }
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Array;
+        node->value = collection;
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::lines(std::shared_ptr<InputSource> source)
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Lines;
+        node->source = std::move(source);
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::fileLines(std::string path)
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Lines;
+        node->path = std::move(path);
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::zip(const Sequence &first, const Sequence &second)
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Zip;
+        node->input = first.node_;
+        node->second = second.node_;
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::map(const FunctionEntry &function, Value operand) const
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Map;
+        node->input = node_;
+        node->value = std::move(operand);
+        node->function = &checkFunction(function, "map");
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::filter(const FunctionEntry &function, Value operand) const
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Filter;
+        node->input = node_;
+        node->value = std::move(operand);
+        node->function = &checkFunction(function, "filter");
+        return Sequence(std::move(node));
+    }
+
+    Sequence Sequence::take(std::size_t count) const
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Take;
+        node->input = node_;
+        node->count = count;
+        return Sequence(std::move(node));
+    }
+
+    std::size_t Sequence::knownSize() const
+    {
+        switch (node_->kind)
+        {
+        case Node::Kind::Range:
+            return node_->count;
+        case Node::Kind::Array:
+            return node_->value.arraySize();
+        case Node::Kind::Map:
+            return Sequence(node_->input).knownSize();
+        case Node::Kind::Lines:
+        case Node::Kind::Filter:
+            return Unknown;
+        case Node::Kind::Take:
+        {
+            std::size_t input = Sequence(node_->input).knownSize();
+            return input == Unknown ? Unknown : std::min(input, node_->count);
+        }
+        case Node::Kind::Zip:
+        {
+            std::size_t first = Sequence(node_->input).knownSize();
+            std::size_t second = Sequence(node_->second).knownSize();
+            return first == Unknown || second == Unknown ? Unknown : std::min(first, second);
+        }
+        }
+        return Unknown;
+    }
+
+    std::size_t Sequence::size() const
+    {
+        std::size_t size = knownSize();
+        if (size != Unknown)
+        {
+            return size;
+        }
+
+        size = 0;
+        Cursor cursor(*this);
+        Value item;
+        while (cursor.next(item))
+        {
+            ++size;
+        }
+        return size;
+    }
+
+    Sequence::Cursor::Cursor(const Sequence &sequence) : root_(sequence.node_)
+    {
+        addState(root_.get());
+    }
+
+    std::uint32_t Sequence::Cursor::addState(const Node *node)
+    {
+        auto index = static_cast<std::uint32_t>(states_.size());
+        states_.push_back({node});
+        if (node->kind == Node::Kind::Lines && !node->source)
+        {
+            states_[index].file = InputSource::open(node->path);
+        }
+        if (node->input)
+        {
+            std::uint32_t input = addState(node->input.get());
+            states_[index].input = input;
+        }
+        if (node->second)
+        {
+            std::uint32_t second = addState(node->second.get());
+            states_[index].second = second;
+        }
+        return index;
+    }
+
+    bool Sequence::Cursor::pull(std::uint32_t index, Value &out)
+    {
+        State &state = states_[index];
+        const Node &node = *state.node;
+        switch (node.kind)
+        {
+        case Node::Kind::Range:
+            if (state.position >= node.count)
+            {
+                return false;
+            }
+            if (node.integral)
+            {
+                out = Value(static_cast<std::int64_t>(node.start) + static_cast<std::int64_t>(state.position++));
+            }
+            else
+            {
+                out = Value(node.start + static_cast<double>(state.position++));
+            }
+            return true;
+
+        case Node::Kind::Array:
+            if (state.position >= node.value.arraySize())
+            {
+                return false;
+            }
+            if (node.value.isStringArray())
+            {
+                out.assignString(node.value.asStringArray().at(state.position++));
+            }
+            else
+            {
+                out = node.value.arrayAt(state.position++);
+            }
+            return true;
+
+        case Node::Kind::Lines:
+        {
+            std::string_view line;
+            InputSource &source = state.file ? *state.file : *node.source;
+            if (!source.readLine(line))
+            {
+                return false;
+            }
+            out.assignString(line);
+            return true;
+        }
+
+        case Node::Kind::Map:
+        {
+            if (!pull(state.input, out))
+            {
+                return false;
+            }
+            Value args[2] = {std::move(out), node.value};
+            out = node.function->invoke(ValueSpan(args, static_cast<std::size_t>(node.function->getArity())));
+            return true;
+        }
+
+        case Node::Kind::Filter:
+            while (pull(state.input, out))
+            {
+                Value args[2] = {out, node.value};
+                if (node.function->invoke(ValueSpan(args, static_cast<std::size_t>(node.function->getArity()))).isTruthy())
+                {
+                    return true;
+                }
+            }
+            return false;
+
+        case Node::Kind::Take:
+            if (state.position >= node.count || !pull(state.input, out))
+            {
+                return false;
+            }
+            ++state.position;
+            return true;
+
+        case Node::Kind::Zip:
+        {
+            Value first, second;
+            if (!pull(state.input, first) || !pull(state.second, second))
+            {
+                return false;
+            }
+            out = Value(std::vector<Value>{std::move(first), std::move(second)});
+            return true;
+        }
+        }
+        return false;
+    }
+
+} // namespace pangea
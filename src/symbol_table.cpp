@@ -0,0 +1,32 @@
+#include "symbol_table.hpp"
+#include <stdexcept>
+
+namespace pangea
+{
+
+    SymbolId SymbolTable::intern(std::string_view name)
+    {
+        auto it = ids_.find(name);
+        if (it != ids_.end())
+        {
+            return it->second;
+        }
+
+        if (names_.size() >= None)
+        {
+            throw std::runtime_error("Too many symbols");
+        }
+
+        SymbolId id = static_cast<SymbolId>(names_.size());
+        const std::string &stored = names_.emplace_back(name);
+        ids_.emplace(stored, id);
+        return id;
+    }
+
+    SymbolId SymbolTable::find(std::string_view name) const
+    {
+        auto it = ids_.find(name);
+        return it != ids_.end() ? it->second : None;
+    }
+
+} // namespace pangea
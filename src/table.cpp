@@ -0,0 +1,545 @@
+#include "table.hpp"
+#include "flat_map.hpp"
+#include "function_entry.hpp"
+#include "object.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace pangea
+{
+
+    namespace
+    {
+        // Rows handed to the kernels at a time when a selection has to be
+        // gathered first; small enough to stay in L1
+        constexpr std::size_t BlockSize = 1024;
+
+        constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+        // Widest range of whole-number keys grouped by direct indexing
+        constexpr std::size_t DenseKeyRange = 1 << 16;
+
+        // The elements of `column` at `rows`, keeping its layout
+        Value gather(const Value &column, const std::uint32_t *rows, std::size_t count)
+        {
+            if (column.isNumberArray())
+            {
+                const double *numbers = column.asNumberArray().data();
+                std::vector<double> out(count);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out[i] = numbers[rows[i]];
+                }
+                return Value(std::move(out));
+            }
+            if (column.isStringArray())
+            {
+                const StringColumn &strings = column.asStringArray();
+                StringColumn out;
+                out.offsets.reserve(count + 1);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    out.push_back(strings.at(rows[i]));
+                }
+                return Value(std::move(out));
+            }
+            const auto &items = column.asArray();
+            std::vector<Value> out;
+            out.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out.push_back(items[rows[i]]);
+            }
+            return Value(std::move(out));
+        }
+
+        // Calls `visit(data, n)` with the numbers of the selected rows, in
+        // place when every row is selected and gathered block by block
+        // otherwise
+        template <typename Visit>
+        void forEachBlock(const double *numbers, const std::vector<std::uint32_t> *selection, std::size_t rows, Visit &&visit)
+        {
+            if (!selection)
+            {
+                if (rows > 0)
+                {
+                    visit(numbers, rows);
+                }
+                return;
+            }
+            std::array<double, BlockSize> block;
+            for (std::size_t base = 0; base < selection->size(); base += BlockSize)
+            {
+                const std::size_t n = std::min(BlockSize, selection->size() - base);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    block[i] = numbers[(*selection)[base + i]];
+                }
+                visit(block.data(), n);
+            }
+        }
+
+        std::vector<std::uint32_t> selectNumbers(VectorMath::Op op, const double *numbers, double operand, const std::vector<std::uint32_t> *selection, std::size_t rows)
+        {
+            std::vector<std::uint32_t> kept;
+            if (!selection)
+            {
+                kept.resize(rows);
+                kept.resize(VectorMath::select(op, numbers, operand, kept.data(), rows));
+            }
+            else
+            {
+                // Positions found in a block are positions in the selection
+                std::array<std::uint32_t, BlockSize> found;
+                std::size_t base = 0;
+                forEachBlock(numbers, selection, rows, [&](const double *block, std::size_t n)
+                             {
+                    std::size_t count = VectorMath::select(op, block, operand, found.data(), n);
+                    for (std::size_t j = 0; j < count; ++j)
+                    {
+                        kept.push_back((*selection)[base + found[j]]);
+                    }
+                    base += n; });
+            }
+            if (kept.size() < kept.capacity() / 2)
+            {
+                kept.shrink_to_fit();
+            }
+            return kept;
+        }
+
+        // less, greater and equal on two strings compare their bytes
+        template <VectorMath::Op O>
+        std::vector<std::uint32_t> selectStrings(const StringColumn &strings, std::string_view operand, const std::vector<std::uint32_t> *selection, std::size_t rows)
+        {
+            std::vector<std::uint32_t> kept;
+            const std::size_t count = selection ? selection->size() : rows;
+            for (std::size_t position = 0; position < count; ++position)
+            {
+                auto row = selection ? (*selection)[position] : static_cast<std::uint32_t>(position);
+                std::string_view text = strings.at(row);
+                bool keep;
+                if constexpr (O == VectorMath::Op::Less)
+                    keep = text < operand;
+                else if constexpr (O == VectorMath::Op::Greater)
+                    keep = text > operand;
+                else
+                    keep = text == operand;
+                if (keep)
+                {
+                    kept.push_back(row);
+                }
+            }
+            return kept;
+        }
+
+        // The numbers of a column; a general array is converted once
+        const double *numbersOf(const Value &column, const std::string &name, std::vector<double> &converted)
+        {
+            if (column.isNumberArray())
+            {
+                return column.asNumberArray().data();
+            }
+            const std::size_t size = column.arraySize();
+            converted.reserve(size);
+            for (std::size_t i = 0; i < size && !column.isStringArray(); ++i)
+            {
+                Value item = column.arrayAt(i);
+                if (!item.isNumber())
+                {
+                    break;
+                }
+                converted.push_back(item.asNumber());
+            }
+            if (converted.size() != size)
+            {
+                throw std::runtime_error("aggregate expects numbers in column " + name);
+            }
+            return converted.data();
+        }
+    } // namespace
+
+    Table Table::fromColumns(const Object &columns)
+    {
+        Table table;
+        for (std::uint32_t slot = 0; slot < columns.size(); ++slot)
+        {
+            const std::string &name = columns.keyAt(slot);
+            const Value &column = columns.valueAt(slot);
+            if (!column.isArray())
+            {
+                throw std::runtime_error("Table column is not an array: " + name);
+            }
+            if (slot == 0)
+            {
+                table.rows_ = column.arraySize();
+            }
+            else if (column.arraySize() != table.rows_)
+            {
+                throw std::runtime_error("Table columns differ in length: " + name);
+            }
+            table.names_.push_back(name);
+            table.columns_.push_back(column);
+        }
+        if (table.rows_ > NotFound)
+        {
+            throw std::runtime_error("Table has too many rows");
+        }
+        return table;
+    }
+
+    std::uint32_t Table::findColumn(std::string_view name) const
+    {
+        auto found = std::find(names_.begin(), names_.end(), name);
+        return found == names_.end() ? NotFound : static_cast<std::uint32_t>(found - names_.begin());
+    }
+
+    std::uint32_t Table::requireColumn(std::string_view name) const
+    {
+        std::uint32_t index = findColumn(name);
+        if (index == NotFound)
+        {
+            throw std::runtime_error("Unknown table column: " + std::string(name));
+        }
+        return index;
+    }
+
+    Value Table::column(std::size_t index) const
+    {
+        if (!selection_)
+        {
+            return columns_[index];
+        }
+        return gather(columns_[index], selection_->data(), selection_->size());
+    }
+
+    Value Table::row(std::size_t index) const
+    {
+        if (index >= rowCount())
+        {
+            throw std::runtime_error("Table row out of range: " + std::to_string(index));
+        }
+        Object fields;
+        const std::uint32_t row = rowAt(index);
+        for (std::size_t i = 0; i < names_.size(); ++i)
+        {
+            fields.set(names_[i], columns_[i].arrayAt(row));
+        }
+        return Value(std::move(fields));
+    }
+
+    Table Table::filter(const Object &conditions, const FunctionEntry &function, std::optional<VectorMath::Op> comparison) const
+    {
+        // Called like a sequence's filter, with the field and the operand
+        if (function.isSpecialForm() || (function.getArity() != 1 && function.getArity() != 2))
+        {
+            throw std::runtime_error("filter expects a function of one or two arguments");
+        }
+
+        // Each condition narrows the selection left by the previous one
+        Table result = *this;
+        result.grouping_ = nullptr;
+        for (std::uint32_t slot = 0; slot < conditions.size(); ++slot)
+        {
+            const Value &column = columns_[requireColumn(conditions.keyAt(slot))];
+            const Value &operand = conditions.valueAt(slot);
+            const std::vector<std::uint32_t> *selection = result.selection_.get();
+
+            std::vector<std::uint32_t> kept;
+            if (comparison && column.isNumberArray() && operand.isNumber())
+            {
+                kept = selectNumbers(*comparison, column.asNumberArray().data(), operand.asNumber(), selection, rows_);
+            }
+            else if (comparison && column.isStringArray() && operand.isString())
+            {
+                const StringColumn &strings = column.asStringArray();
+                const std::string &text = operand.asString();
+                switch (*comparison)
+                {
+                case VectorMath::Op::Less:
+                    kept = selectStrings<VectorMath::Op::Less>(strings, text, selection, rows_);
+                    break;
+                case VectorMath::Op::Greater:
+                    kept = selectStrings<VectorMath::Op::Greater>(strings, text, selection, rows_);
+                    break;
+                default:
+                    kept = selectStrings<VectorMath::Op::Equal>(strings, text, selection, rows_);
+                    break;
+                }
+            }
+            else
+            {
+                const std::size_t arity = static_cast<std::size_t>(function.getArity());
+                for (std::size_t position = 0; position < result.rowCount(); ++position)
+                {
+                    const std::uint32_t row = result.rowAt(position);
+                    Value args[2] = {column.arrayAt(row), operand};
+                    if (function.invoke(ValueSpan(args, arity)).isTruthy())
+                    {
+                        kept.push_back(row);
+                    }
+                }
+            }
+            result.selection_ = std::make_shared<const std::vector<std::uint32_t>>(std::move(kept));
+        }
+        return result;
+    }
+
+    Table Table::select(const std::vector<std::string> &names) const
+    {
+        Table result;
+        result.rows_ = rows_;
+        result.selection_ = selection_;
+        for (const std::string &name : names)
+        {
+            if (result.findColumn(name) != NotFound)
+            {
+                throw std::runtime_error("Column selected twice: " + name);
+            }
+            result.names_.push_back(name);
+            result.columns_.push_back(columns_[requireColumn(name)]);
+        }
+        return result;
+    }
+
+    Table Table::groupBy(std::string_view name) const
+    {
+        auto grouping = std::make_shared<Grouping>();
+        grouping->keyColumn = requireColumn(name);
+        const Value &column = columns_[grouping->keyColumn];
+        const std::size_t count = rowCount();
+        grouping->groupOf.resize(count);
+
+        // Entries are created in order of first appearance, so an entry's
+        // index is its group and its value the row it was first seen on
+        FlatMap<std::uint32_t> groups;
+        if (column.isNumberArray() && !groupDense(column.asNumberArray().data(), *grouping))
+        {
+            // Other numbers are keyed by their bits, with -0 as 0 and one NaN
+            const auto &numbers = column.asNumberArray();
+            for (std::size_t position = 0; position < count; ++position)
+            {
+                const std::uint32_t row = rowAt(position);
+                double number = numbers[row];
+                auto bits = std::bit_cast<std::uint64_t>(std::isnan(number) ? NaN : number + 0.0);
+                grouping->groupOf[position] = groups.insert(std::string_view(reinterpret_cast<const char *>(&bits), sizeof(bits)), row).first;
+            }
+        }
+        else if (column.isStringArray())
+        {
+            // Rows are often sorted or clustered by their key, so a key
+            // equal to the previous row's skips the hash lookup
+            const StringColumn &strings = column.asStringArray();
+            std::string_view previous;
+            std::uint32_t group = NotFound;
+            for (std::size_t position = 0; position < count; ++position)
+            {
+                const std::uint32_t row = rowAt(position);
+                std::string_view key = strings.at(row);
+                if (group == NotFound || key != previous)
+                {
+                    group = groups.insert(key, row).first;
+                    previous = key;
+                }
+                grouping->groupOf[position] = group;
+            }
+        }
+        else if (!column.isNumberArray())
+        {
+            for (std::size_t position = 0; position < count; ++position)
+            {
+                const std::uint32_t row = rowAt(position);
+                grouping->groupOf[position] = groups.insert(column.arrayAt(row).toString(), row).first;
+            }
+        }
+
+        for (const auto &entry : groups)
+        {
+            grouping->firstRows.push_back(entry.value);
+        }
+
+        Table result = *this;
+        result.grouping_ = std::move(grouping);
+        return result;
+    }
+
+    bool Table::groupDense(const double *numbers, Grouping &grouping) const
+    {
+        // Codes, years and counts are whole numbers in a narrow range: each
+        // indexes its group directly instead of being hashed
+        const std::size_t count = rowCount();
+        if (count == 0)
+        {
+            return false;
+        }
+        double low = numbers[rowAt(0)];
+        double high = low;
+        for (std::size_t position = 0; position < count; ++position)
+        {
+            double number = numbers[rowAt(position)];
+            if (number != std::floor(number))
+            {
+                return false;
+            }
+            low = std::min(low, number);
+            high = std::max(high, number);
+        }
+        if (high - low >= static_cast<double>(std::min(DenseKeyRange, std::max(count, BlockSize))))
+        {
+            return false;
+        }
+
+        std::vector<std::uint32_t> groupOfKey(static_cast<std::size_t>(high - low) + 1, NotFound);
+        for (std::size_t position = 0; position < count; ++position)
+        {
+            const std::uint32_t row = rowAt(position);
+            std::uint32_t &group = groupOfKey[static_cast<std::size_t>(numbers[row] - low)];
+            if (group == NotFound)
+            {
+                group = static_cast<std::uint32_t>(grouping.firstRows.size());
+                grouping.firstRows.push_back(row);
+            }
+            grouping.groupOf[position] = group;
+        }
+        return true;
+    }
+
+    Table Table::aggregate(const Object &spec) const
+    {
+        const std::size_t groups = grouping_ ? grouping_->firstRows.size() : 1;
+        const std::size_t count = rowCount();
+
+        Table result;
+        result.rows_ = groups;
+        if (grouping_)
+        {
+            result.names_.push_back(names_[grouping_->keyColumn]);
+            result.columns_.push_back(gather(columns_[grouping_->keyColumn], grouping_->firstRows.data(), groups));
+        }
+
+        for (std::uint32_t slot = 0; slot < spec.size(); ++slot)
+        {
+            const std::string &name = spec.keyAt(slot);
+            const std::uint32_t index = requireColumn(name);
+            if (grouping_ && index == grouping_->keyColumn)
+            {
+                throw std::runtime_error("aggregate cannot reduce the grouping column " + name);
+            }
+            const Value &how = spec.valueAt(slot);
+            const std::string reduction = how.isString() ? how.asString() : how.toString();
+            const bool isSum = reduction == "sum";
+            const bool isMean = reduction == "mean";
+            const bool isMin = reduction == "min";
+            const bool isMax = reduction == "max";
+            if (!isSum && !isMean && !isMin && !isMax && reduction != "count")
+            {
+                throw std::runtime_error("Unknown aggregate reduction: " + reduction);
+            }
+
+            std::vector<double> out(groups, 0.0);
+            std::vector<double> counts(groups, 0.0);
+            if (grouping_)
+            {
+                for (std::uint32_t group : grouping_->groupOf)
+                {
+                    counts[group] += 1.0;
+                }
+            }
+            else
+            {
+                counts[0] = static_cast<double>(count);
+            }
+
+            if (reduction == "count")
+            {
+                out = std::move(counts);
+            }
+            else if (!grouping_)
+            {
+                // One group: the kernels reduce the selected rows by blocks
+                std::vector<double> converted;
+                const double *numbers = numbersOf(columns_[index], name, converted);
+                CompensatedSum total;
+                double best = NaN;
+                bool empty = true;
+                forEachBlock(numbers, selection_.get(), rows_, [&](const double *block, std::size_t n)
+                             {
+                    if (isSum || isMean)
+                    {
+                        total.add(VectorMath::sum(block, n));
+                        return;
+                    }
+                    if (!empty && std::isnan(best))
+                    {
+                        return;
+                    }
+                    double candidate = isMax ? VectorMath::max(block, n) : VectorMath::min(block, n);
+                    if (empty || std::isnan(candidate) || (isMax ? candidate > best : candidate < best))
+                    {
+                        best = candidate;
+                    }
+                    empty = false; });
+                out[0] = isSum ? total.value() : isMean ? (count == 0 ? NaN : total.value() / static_cast<double>(count)) : best;
+            }
+            else
+            {
+                // Per-group accumulators, updated in one pass over the rows
+                std::vector<double> converted;
+                const double *numbers = numbersOf(columns_[index], name, converted);
+                const std::vector<std::uint32_t> &groupOf = grouping_->groupOf;
+                if (isSum || isMean)
+                {
+                    std::vector<CompensatedSum> totals(groups);
+                    for (std::size_t position = 0; position < count; ++position)
+                    {
+                        totals[groupOf[position]].add(numbers[rowAt(position)]);
+                    }
+                    for (std::size_t group = 0; group < groups; ++group)
+                    {
+                        out[group] = isSum ? totals[group].value() : totals[group].value() / counts[group];
+                    }
+                }
+                else
+                {
+                    // A NaN, once met, stays the group's result
+                    const double start = isMax ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+                    std::fill(out.begin(), out.end(), start);
+                    for (std::size_t position = 0; position < count; ++position)
+                    {
+                        double number = numbers[rowAt(position)];
+                        double &best = out[groupOf[position]];
+                        if ((isMax ? number > best : number < best) || std::isnan(number))
+                        {
+                            best = number;
+                        }
+                    }
+                }
+            }
+
+            result.names_.push_back(name);
+            result.columns_.push_back(Value(std::move(out)));
+        }
+        return result;
+    }
+
+    bool Table::operator==(const Table &other) const
+    {
+        if (names_ != other.names_ || rowCount() != other.rowCount())
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < names_.size(); ++i)
+        {
+            if (column(i) != other.column(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace pangea
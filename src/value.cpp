@@ -1,214 +1,798 @@
 #include "value.hpp"
 #include "function_entry.hpp"
+#include "object.hpp"
+#include "output_sink.hpp"
+#include "sequence.hpp"
+#include "table.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <stdexcept>
-#include <sstream>
 
 namespace pangea
 {
 
+    namespace
+    {
+        // Heap payloads, one per non-inline type
+        // A flat string, or a rope node whose bytes are the concatenation of
+        // its two children until the first flatten() replaces them
+        struct StringObject : Value::HeapObject
+        {
+            mutable std::string value;
+            mutable StringObject *left = nullptr;
+            mutable StringObject *right = nullptr;
+            std::size_t length;
+
+            explicit StringObject(std::string value) : HeapObject(Value::Type::String), value(std::move(value)), length(this->value.size()) {}
+
+            StringObject(StringObject *left, StringObject *right)
+                : HeapObject(Value::Type::String), left(left), right(right), length(left->length + right->length)
+            {
+                ++left->refCount;
+                ++right->refCount;
+            }
+
+            ~StringObject() override { releaseChildren(); }
+
+            HeapObject *clone() const override { return new StringObject(flatten()); }
+
+            bool isRope() const { return left != nullptr; }
+
+            const std::string &flatten() const
+            {
+                if (!isRope())
+                {
+                    return value;
+                }
+
+                // Walk the leaves left to right with an explicit stack, since
+                // ropes built by a loop are as deep as its iteration count
+                std::string flat;
+                flat.reserve(length);
+                std::vector<const StringObject *> pending = {right, left};
+                while (!pending.empty())
+                {
+                    const StringObject *node = pending.back();
+                    pending.pop_back();
+                    if (node->isRope())
+                    {
+                        pending.push_back(node->right);
+                        pending.push_back(node->left);
+                    }
+                    else
+                    {
+                        flat += node->value;
+                    }
+                }
+
+                value = std::move(flat);
+                releaseChildren();
+                return value;
+            }
+
+            // Drops the references to both children. Nodes freed as a result
+            // are unlinked iteratively rather than by recursive destructors
+            void releaseChildren() const
+            {
+                if (!isRope())
+                {
+                    return;
+                }
+
+                std::vector<StringObject *> pending = {left, right};
+                left = right = nullptr;
+                while (!pending.empty())
+                {
+                    StringObject *node = pending.back();
+                    pending.pop_back();
+                    if (--node->refCount == 0)
+                    {
+                        if (node->isRope())
+                        {
+                            pending.push_back(node->left);
+                            pending.push_back(node->right);
+                            node->left = node->right = nullptr;
+                        }
+                        delete node;
+                    }
+                }
+            }
+        };
+
+        // Below this many bytes a concatenation is copied into a flat string
+        constexpr std::size_t RopeThreshold = 64;
+
+        struct ArrayObject : Value::HeapObject
+        {
+            std::vector<Value> value;
+
+            explicit ArrayObject(std::vector<Value> value) : HeapObject(Value::Type::Array), value(std::move(value)) {}
+            HeapObject *clone() const override { return new ArrayObject(value); }
+        };
+
+        // An array whose elements are all numbers, stored unboxed. The boxed
+        // copy handed out by asArray() is built on demand and dropped when
+        // the numbers are mutated
+        struct NumberArrayObject : Value::HeapObject
+        {
+            std::vector<double> value;
+            mutable std::vector<Value> boxed;
+            mutable bool boxedValid = false;
+
+            explicit NumberArrayObject(std::vector<double> value) : HeapObject(Value::Type::Array), value(std::move(value))
+            {
+                layout = Layout::Numbers;
+            }
+            HeapObject *clone() const override { return new NumberArrayObject(value); }
+
+            const std::vector<Value> &box() const
+            {
+                if (!boxedValid)
+                {
+                    boxed = std::vector<Value>(value.begin(), value.end());
+                    boxedValid = true;
+                }
+                return boxed;
+            }
+        };
+
+        // An array of strings stored as one StringColumn, boxed like a
+        // NumberArrayObject
+        struct StringArrayObject : Value::HeapObject
+        {
+            StringColumn value;
+            mutable std::vector<Value> boxed;
+            mutable bool boxedValid = false;
+
+            explicit StringArrayObject(StringColumn value) : HeapObject(Value::Type::Array), value(std::move(value))
+            {
+                layout = Layout::Strings;
+            }
+            HeapObject *clone() const override { return new StringArrayObject(value); }
+
+            const std::vector<Value> &box() const
+            {
+                if (!boxedValid)
+                {
+                    boxed.reserve(value.size());
+                    for (std::size_t i = 0; i < value.size(); ++i)
+                    {
+                        boxed.emplace_back(std::string(value.at(i)));
+                    }
+                    boxedValid = true;
+                }
+                return boxed;
+            }
+        };
+
+        // Whether an array can be stored packed
+        bool allNumbers(const std::vector<Value> &values)
+        {
+            for (const Value &value : values)
+            {
+                if (!value.isNumber())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::vector<double> unboxNumbers(const std::vector<Value> &values)
+        {
+            std::vector<double> numbers;
+            numbers.reserve(values.size());
+            for (const Value &value : values)
+            {
+                numbers.push_back(value.asNumber());
+            }
+            return numbers;
+        }
+
+        struct ObjectObject : Value::HeapObject
+        {
+            Object value;
+
+            explicit ObjectObject(Object value) : HeapObject(Value::Type::Object), value(std::move(value)) {}
+            HeapObject *clone() const override { return new ObjectObject(value); }
+        };
+
+        struct FunctionObject : Value::HeapObject
+        {
+            std::shared_ptr<FunctionEntry> value;
+
+            explicit FunctionObject(std::shared_ptr<FunctionEntry> value) : HeapObject(Value::Type::Function), value(std::move(value)) {}
+            HeapObject *clone() const override { return new FunctionObject(value); }
+        };
+
+        struct SequenceObject : Value::HeapObject
+        {
+            Sequence value;
+
+            explicit SequenceObject(Sequence value) : HeapObject(Value::Type::Sequence), value(std::move(value)) {}
+            HeapObject *clone() const override { return new SequenceObject(value); }
+        };
+
+        struct TableObject : Value::HeapObject
+        {
+            Table value;
+
+            explicit TableObject(Table value) : HeapObject(Value::Type::Table), value(std::move(value)) {}
+            HeapObject *clone() const override { return new TableObject(value); }
+        };
+    } // namespace
+
     // Constructors
-    Value::Value() : data_(std::monostate{}), type_(Type::Null) {}
+    Value::Value(HeapObject *object) : bits_(HeapTag | static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(object)))
+    {
+        if ((reinterpret_cast<std::uintptr_t>(object) & ~static_cast<std::uintptr_t>(PayloadMask)) != 0)
+        {
+            delete object;
+            throw std::runtime_error("Heap address does not fit in a NaN-boxed value");
+        }
+    }
+
+    Value::Value(const std::string &value) : Value(new StringObject(value)) {}
+
+    Value::Value(std::string &&value) : Value(new StringObject(std::move(value))) {}
+
+    Value::Value(const char *value) : Value(new StringObject(value)) {}
+
+    Value::Value(const std::vector<Value> &value)
+        : Value(allNumbers(value) ? static_cast<HeapObject *>(new NumberArrayObject(unboxNumbers(value))) : new ArrayObject(value))
+    {
+    }
+
+    Value::Value(std::vector<Value> &&value)
+        : Value(allNumbers(value) ? static_cast<HeapObject *>(new NumberArrayObject(unboxNumbers(value))) : new ArrayObject(std::move(value)))
+    {
+    }
 
-    Value::Value(double value) : data_(value), type_(Type::Number) {}
+    Value::Value(std::vector<double> numbers) : Value(new NumberArrayObject(std::move(numbers))) {}
 
-    Value::Value(const std::string &value) : data_(value), type_(Type::String) {}
+    Value::Value(StringColumn strings) : Value(new StringArrayObject(std::move(strings))) {}
 
-    Value::Value(bool value) : data_(value), type_(Type::Boolean) {}
+    Value::Value(const Object &value) : Value(new ObjectObject(value)) {}
 
-    Value::Value(const std::vector<Value> &value) : data_(value), type_(Type::Array) {}
+    Value::Value(Object &&value) : Value(new ObjectObject(std::move(value))) {}
 
-    Value::Value(const std::unordered_map<std::string, Value> &value) : data_(value), type_(Type::Object) {}
+    Value::Value(const std::unordered_map<std::string, Value> &value) : Value()
+    {
+        // Keys are inserted in the map's iteration order
+        Object object;
+        for (const auto &[key, item] : value)
+        {
+            object.set(key, item);
+        }
+        *this = Value(std::move(object));
+    }
+
+    Value::Value(std::shared_ptr<FunctionEntry> function) : Value(new FunctionObject(std::move(function))) {}
+
+    Value::Value(Sequence sequence) : Value(new SequenceObject(std::move(sequence))) {}
+
+    Value::Value(Table table) : Value(new TableObject(std::move(table))) {}
+
+    // Reference counting
+    Value::HeapObject *Value::detach(Type type, const char *error)
+    {
+        if (!isHeapType(type))
+        {
+            throw std::runtime_error(error);
+        }
+
+        // Copy-on-write: take a private copy before the first mutation
+        if (heap()->refCount > 1)
+        {
+            HeapObject *copy = heap()->clone();
+            release();
+            *this = Value(copy);
+        }
+        return heap();
+    }
 
-    Value::Value(std::shared_ptr<FunctionEntry> function) : data_(function), type_(Type::Function) {}
+    Value Value::concat(const Value &left, const Value &right)
+    {
+        if (!left.isString() || !right.isString())
+        {
+            throw std::runtime_error("Value is not a string");
+        }
+
+        auto *leftString = static_cast<StringObject *>(left.heap());
+        auto *rightString = static_cast<StringObject *>(right.heap());
+        if (leftString->length == 0)
+        {
+            return right;
+        }
+        if (rightString->length == 0)
+        {
+            return left;
+        }
+
+        if (leftString->length + rightString->length < RopeThreshold)
+        {
+            return Value(leftString->flatten() + rightString->flatten());
+        }
+        return Value(new StringObject(leftString, rightString));
+    }
+
+    void Value::assignString(std::string_view text)
+    {
+        if (isString() && !isShared())
+        {
+            auto *string = static_cast<StringObject *>(heap());
+            string->releaseChildren();
+            string->value.assign(text);
+            string->length = text.size();
+            return;
+        }
+        *this = Value(std::string(text));
+    }
+
+    std::size_t Value::stringLength() const
+    {
+        if (!isString())
+        {
+            throw std::runtime_error("Value is not a string");
+        }
+        return static_cast<const StringObject *>(heap())->length;
+    }
+
+    Value::Type Value::getType() const
+    {
+        if (isNumber())
+        {
+            return Type::Number;
+        }
+        if (isBoolean())
+        {
+            return Type::Boolean;
+        }
+        if (isHeap())
+        {
+            return heap()->type;
+        }
+        return Type::Null;
+    }
 
     // Value getters with type checking
     double Value::asNumber() const
     {
-        if (type_ != Type::Number)
+        if (isInteger())
+        {
+            return static_cast<double>(integerPayload());
+        }
+        if (!isDouble())
         {
             throw std::runtime_error("Value is not a number");
         }
-        return std::get<double>(data_);
+        double value;
+        std::memcpy(&value, &bits_, sizeof(value));
+        return value;
+    }
+
+    std::int64_t Value::asInteger() const
+    {
+        if (!isInteger())
+        {
+            throw std::runtime_error("Value is not an integer");
+        }
+        return integerPayload();
     }
 
     const std::string &Value::asString() const
     {
-        if (type_ != Type::String)
+        if (!isString())
         {
             throw std::runtime_error("Value is not a string");
         }
-        return std::get<std::string>(data_);
+        return static_cast<const StringObject *>(heap())->flatten();
     }
 
     bool Value::asBoolean() const
     {
-        if (type_ != Type::Boolean)
+        if (!isBoolean())
         {
             throw std::runtime_error("Value is not a boolean");
         }
-        return std::get<bool>(data_);
+        return (bits_ & PayloadMask) != 0;
     }
 
     const std::vector<Value> &Value::asArray() const
     {
-        if (type_ != Type::Array)
+        if (!isArray())
+        {
+            throw std::runtime_error("Value is not an array");
+        }
+        switch (heap()->layout)
+        {
+        case HeapObject::Layout::Numbers:
+            return static_cast<const NumberArrayObject *>(heap())->box();
+        case HeapObject::Layout::Strings:
+            return static_cast<const StringArrayObject *>(heap())->box();
+        default:
+            return static_cast<const ArrayObject *>(heap())->value;
+        }
+    }
+
+    const std::vector<double> &Value::asNumberArray() const
+    {
+        if (!isNumberArray())
+        {
+            throw std::runtime_error("Value is not a number array");
+        }
+        return static_cast<const NumberArrayObject *>(heap())->value;
+    }
+
+    const StringColumn &Value::asStringArray() const
+    {
+        if (!isStringArray())
+        {
+            throw std::runtime_error("Value is not a string array");
+        }
+        return static_cast<const StringArrayObject *>(heap())->value;
+    }
+
+    std::size_t Value::arraySize() const
+    {
+        if (!isArray())
         {
             throw std::runtime_error("Value is not an array");
         }
-        return std::get<std::vector<Value>>(data_);
+        switch (heap()->layout)
+        {
+        case HeapObject::Layout::Numbers:
+            return static_cast<const NumberArrayObject *>(heap())->value.size();
+        case HeapObject::Layout::Strings:
+            return static_cast<const StringArrayObject *>(heap())->value.size();
+        default:
+            return static_cast<const ArrayObject *>(heap())->value.size();
+        }
     }
 
-    const std::unordered_map<std::string, Value> &Value::asObject() const
+    Value Value::arrayAt(std::size_t index) const
     {
-        if (type_ != Type::Object)
+        if (index >= arraySize())
+        {
+            throw std::runtime_error("Array index out of range: " + std::to_string(index));
+        }
+        switch (heap()->layout)
+        {
+        case HeapObject::Layout::Numbers:
+            return Value(static_cast<const NumberArrayObject *>(heap())->value[index]);
+        case HeapObject::Layout::Strings:
+            return Value(std::string(static_cast<const StringArrayObject *>(heap())->value.at(index)));
+        default:
+            return static_cast<const ArrayObject *>(heap())->value[index];
+        }
+    }
+
+    const Object &Value::asObject() const
+    {
+        if (!isObject())
         {
             throw std::runtime_error("Value is not an object");
         }
-        return std::get<std::unordered_map<std::string, Value>>(data_);
+        return static_cast<const ObjectObject *>(heap())->value;
+    }
+
+    const Sequence &Value::asSequence() const
+    {
+        if (!isSequence())
+        {
+            throw std::runtime_error("Value is not a sequence");
+        }
+        return static_cast<const SequenceObject *>(heap())->value;
+    }
+
+    const Table &Value::asTable() const
+    {
+        if (!isTable())
+        {
+            throw std::runtime_error("Value is not a table");
+        }
+        return static_cast<const TableObject *>(heap())->value;
     }
 
     std::shared_ptr<FunctionEntry> Value::asFunction() const
     {
-        if (type_ != Type::Function)
+        if (!isFunction())
         {
             throw std::runtime_error("Value is not a function");
         }
-        return std::get<std::shared_ptr<FunctionEntry>>(data_);
+        return static_cast<const FunctionObject *>(heap())->value;
     }
 
     // Mutable getters
     std::vector<Value> &Value::asArrayMutable()
     {
-        if (type_ != Type::Array)
+        // A packed array or a string column becomes a general one, since
+        // the caller may store anything in it
+        if (isNumberArray())
         {
-            throw std::runtime_error("Value is not an array");
+            const auto &numbers = asNumberArray();
+            *this = Value(new ArrayObject(std::vector<Value>(numbers.begin(), numbers.end())));
         }
-        return std::get<std::vector<Value>>(data_);
+        else if (isStringArray())
+        {
+            const auto &strings = asStringArray();
+            std::vector<Value> items;
+            items.reserve(strings.size());
+            for (std::size_t i = 0; i < strings.size(); ++i)
+            {
+                items.emplace_back(std::string(strings.at(i)));
+            }
+            *this = Value(new ArrayObject(std::move(items)));
+        }
+        return static_cast<ArrayObject *>(detach(Type::Array, "Value is not an array"))->value;
     }
 
-    std::unordered_map<std::string, Value> &Value::asObjectMutable()
+    std::vector<double> &Value::asNumberArrayMutable()
     {
-        if (type_ != Type::Object)
+        if (!isNumberArray())
         {
-            throw std::runtime_error("Value is not an object");
+            throw std::runtime_error("Value is not a number array");
         }
-        return std::get<std::unordered_map<std::string, Value>>(data_);
+        auto *numbers = static_cast<NumberArrayObject *>(detach(Type::Array, "Value is not an array"));
+        numbers->boxed.clear();
+        numbers->boxedValid = false;
+        return numbers->value;
+    }
+
+    Object &Value::asObjectMutable()
+    {
+        return static_cast<ObjectObject *>(detach(Type::Object, "Value is not an object"))->value;
     }
 
     // Truthiness evaluation (JavaScript-like)
     bool Value::isTruthy() const
     {
-        switch (type_)
+        switch (getType())
         {
         case Type::Null:
             return false;
         case Type::Number:
             return asNumber() != 0.0;
         case Type::String:
-            return !asString().empty();
+            return stringLength() != 0;
         case Type::Boolean:
             return asBoolean();
         case Type::Array:
-            return !asArray().empty();
+            return arraySize() != 0;
         case Type::Object:
             return !asObject().empty();
         case Type::Function:
             return asFunction() != nullptr;
+        case Type::Sequence:
+            return true;
+        case Type::Table:
+            return asTable().rowCount() != 0;
         default:
             return false;
         }
     }
 
+    namespace
+    {
+        // Longest shortest-round-trip text, "-2.2250738585072014e-308",
+        // plus room for a whole number printed in full
+        constexpr std::size_t NumberTextSize = 32;
+
+        std::string_view formatNumber(double number, char (&text)[NumberTextSize])
+        {
+            char *end;
+            if (number == std::floor(number) && std::abs(number) < 1e21)
+            {
+                // Whole numbers print in full, and -0 as 0
+                end = std::to_chars(text, text + NumberTextSize, number + 0.0, std::chars_format::fixed).ptr;
+            }
+            else
+            {
+                end = std::to_chars(text, text + NumberTextSize, number).ptr;
+            }
+            return std::string_view(text, static_cast<std::size_t>(end - text));
+        }
+
+        std::string_view formatInteger(std::int64_t number, char (&text)[NumberTextSize])
+        {
+            char *end = std::to_chars(text, text + NumberTextSize, number).ptr;
+            return std::string_view(text, static_cast<std::size_t>(end - text));
+        }
+    } // namespace
+
     // String conversion
     std::string Value::toString() const
     {
-        switch (type_)
+        char text[NumberTextSize];
+        switch (getType())
         {
         case Type::Null:
             return "null";
         case Type::Number:
-        {
-            double num = asNumber();
-            if (num == static_cast<long>(num))
-            {
-                return std::to_string(static_cast<long>(num));
-            }
-            return std::to_string(num);
-        }
+            return std::string(isInteger() ? formatInteger(integerPayload(), text) : formatNumber(asNumber(), text));
         case Type::String:
             return asString();
         case Type::Boolean:
             return asBoolean() ? "true" : "false";
+        default:
+        {
+            StringSink sink;
+            writeTo(sink);
+            return std::move(sink.str());
+        }
+        }
+    }
+
+    void Value::writeTo(OutputSink &sink) const
+    {
+        char text[NumberTextSize];
+        switch (getType())
+        {
+        case Type::Null:
+            sink.write("null");
+            break;
+        case Type::Number:
+            sink.write(isInteger() ? formatInteger(integerPayload(), text) : formatNumber(asNumber(), text));
+            break;
+        case Type::String:
+            sink.write(asString());
+            break;
+        case Type::Boolean:
+            sink.write(asBoolean() ? "true" : "false");
+            break;
         case Type::Array:
         {
-            std::ostringstream oss;
-            oss << "[";
-            const auto &arr = asArray();
-            for (size_t i = 0; i < arr.size(); ++i)
+            // Packed elements are formatted straight from their doubles, and
+            // column strings written from their buffer
+            sink.put('[');
+            if (isNumberArray())
             {
-                if (i > 0)
-                    oss << ", ";
-                oss << arr[i].toString();
+                const auto &numbers = asNumberArray();
+                for (std::size_t i = 0; i < numbers.size(); ++i)
+                {
+                    if (i > 0)
+                        sink.write(", ");
+                    sink.write(formatNumber(numbers[i], text));
+                }
             }
-            oss << "]";
-            return oss.str();
+            else if (isStringArray())
+            {
+                const auto &strings = asStringArray();
+                for (std::size_t i = 0; i < strings.size(); ++i)
+                {
+                    if (i > 0)
+                        sink.write(", ");
+                    sink.write(strings.at(i));
+                }
+            }
+            else
+            {
+                const auto &items = asArray();
+                for (std::size_t i = 0; i < items.size(); ++i)
+                {
+                    if (i > 0)
+                        sink.write(", ");
+                    items[i].writeTo(sink);
+                }
+            }
+            sink.put(']');
+            break;
         }
         case Type::Object:
         {
-            std::ostringstream oss;
-            oss << "{";
+            sink.put('{');
             const auto &obj = asObject();
-            bool first = true;
-            for (const auto &[key, value] : obj)
+            for (std::uint32_t slot = 0; slot < obj.size(); ++slot)
             {
-                if (!first)
-                    oss << ", ";
-                oss << "\"" << key << "\": " << value.toString();
-                first = false;
+                if (slot > 0)
+                    sink.write(", ");
+                sink.put('"');
+                sink.write(obj.keyAt(slot));
+                sink.write("\": ");
+                obj.valueAt(slot).writeTo(sink);
             }
-            oss << "}";
-            return oss.str();
+            sink.put('}');
+            break;
         }
         case Type::Function:
         {
             auto func = asFunction();
-            return "[Function:" + std::to_string(func ? func->getArity() : 0) + "]";
+            sink.write("[Function:");
+            sink.write(formatInteger(func ? func->getArity() : 0, text));
+            sink.put(']');
+            break;
+        }
+        case Type::Sequence:
+            sink.write("[Sequence]");
+            break;
+        case Type::Table:
+        {
+            // Written as the object of its selected columns
+            const auto &table = asTable();
+            sink.put('{');
+            for (std::size_t i = 0; i < table.columnCount(); ++i)
+            {
+                if (i > 0)
+                    sink.write(", ");
+                sink.put('"');
+                sink.write(table.nameAt(i));
+                sink.write("\": ");
+                table.column(i).writeTo(sink);
+            }
+            sink.put('}');
+            break;
         }
-        default:
-            return "undefined";
         }
     }
 
     // Print utility
     void Value::print(std::ostream &os) const
     {
-        os << toString();
+        StreamSink sink(os);
+        writeTo(sink);
     }
 
     // Comparison operators
     bool Value::operator==(const Value &other) const
     {
-        if (type_ != other.type_)
+        Type type = getType();
+        if (type != other.getType())
         {
             return false;
         }
 
-        switch (type_)
+        switch (type)
         {
         case Type::Null:
             return true;
         case Type::Number:
-            return asNumber() == other.asNumber();
-        case Type::String:
-            return asString() == other.asString();
+            // Inline integers are exact, so mixed pairs compare as doubles
+            return isInteger() && other.isInteger() ? bits_ == other.bits_ : asNumber() == other.asNumber();
         case Type::Boolean:
             return asBoolean() == other.asBoolean();
+        default:
+            break;
+        }
+
+        // Shared heap storage is trivially equal
+        if (bits_ == other.bits_)
+        {
+            return true;
+        }
+
+        switch (type)
+        {
+        case Type::String:
+            return stringLength() == other.stringLength() && asString() == other.asString();
         case Type::Array:
-            return asArray() == other.asArray();
+        {
+            if (isNumberArray() && other.isNumberArray())
+            {
+                return asNumberArray() == other.asNumberArray();
+            }
+            const std::size_t size = arraySize();
+            if (size != other.arraySize())
+            {
+                return false;
+            }
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                if (arrayAt(i) != other.arrayAt(i))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
         case Type::Object:
             return asObject() == other.asObject();
         case Type::Function:
             return asFunction() == other.asFunction();
+        case Type::Sequence:
+            return asSequence() == other.asSequence();
+        case Type::Table:
+            return asTable() == other.asTable();
         default:
             return false;
         }
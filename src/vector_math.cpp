@@ -0,0 +1,699 @@
+#include "vector_math.hpp"
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define PANGEA_VECTOR_X86 1
+#include <immintrin.h>
+#endif
+
+namespace pangea
+{
+
+    namespace
+    {
+        using Op = VectorMath::Op;
+        using BinaryKernel = void (*)(const double *, const double *, double *, std::size_t);
+        using ReduceKernel = double (*)(const double *, std::size_t);
+        using DotKernel = double (*)(const double *, const double *, std::size_t);
+        using CountKernel = std::size_t (*)(const double *, std::size_t);
+        using SelectKernel = std::size_t (*)(const double *, double, std::uint32_t *, std::size_t);
+
+        constexpr int OpCount = static_cast<int>(Op::Equal) + 1;
+        constexpr int FirstComparison = static_cast<int>(Op::Less);
+        constexpr int ComparisonCount = OpCount - FirstComparison;
+
+        // binary[op][mode]: mode 0 has no broadcast operand, 1 broadcasts
+        // `a` and 2 broadcasts `b`
+        struct Kernels
+        {
+            VectorMath::Backend backend;
+            BinaryKernel binary[OpCount][3];
+            ReduceKernel sum;
+            DotKernel dot;
+            ReduceKernel min;
+            ReduceKernel max;
+            CountKernel countNonZero;
+            SelectKernel select[ComparisonCount];
+        };
+
+        template <Op O>
+        inline double scalarOp(double x, double y)
+        {
+            if constexpr (O == Op::Add)
+                return x + y;
+            else if constexpr (O == Op::Subtract)
+                return x - y;
+            else if constexpr (O == Op::Multiply)
+                return x * y;
+            else if constexpr (O == Op::Divide)
+                return x / y;
+            else if constexpr (O == Op::Power)
+                return std::pow(x, y);
+            else if constexpr (O == Op::Less)
+                return x < y ? 1.0 : 0.0;
+            else if constexpr (O == Op::Greater)
+                return x > y ? 1.0 : 0.0;
+            else
+                return x == y ? 1.0 : 0.0;
+        }
+
+        // Scalar reference backend, also used for the tails of vector loops
+        template <Op O, bool BroadcastA, bool BroadcastB>
+        inline void binaryTail(const double *a, const double *b, double *out, std::size_t i, std::size_t n)
+        {
+            for (; i < n; ++i)
+            {
+                out[i] = scalarOp<O>(BroadcastA ? a[0] : a[i], BroadcastB ? b[0] : b[i]);
+            }
+        }
+
+        template <Op O, bool BroadcastA, bool BroadcastB>
+        struct ScalarBinary
+        {
+            static void run(const double *a, const double *b, double *out, std::size_t n)
+            {
+                binaryTail<O, BroadcastA, BroadcastB>(a, b, out, 0, n);
+            }
+        };
+
+        template <template <Op, bool, bool> class Kernel, Op O>
+        constexpr void addRow(Kernels &kernels)
+        {
+            kernels.binary[static_cast<int>(O)][0] = Kernel<O, false, false>::run;
+            kernels.binary[static_cast<int>(O)][1] = Kernel<O, true, false>::run;
+            kernels.binary[static_cast<int>(O)][2] = Kernel<O, false, true>::run;
+        }
+
+        // Neumaier's compensated addition of x into (sum, compensation)
+        inline void addCompensated(double &sum, double &compensation, double x)
+        {
+            double total = sum + x;
+            compensation += std::fabs(sum) >= std::fabs(x) ? (sum - total) + x : (x - total) + sum;
+            sum = total;
+        }
+
+        // Combines per-lane partial sums and compensations
+        inline double combineLanes(const double *sums, const double *compensations, std::size_t lanes, double sum, double compensation)
+        {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                addCompensated(sum, compensation, sums[lane]);
+                compensation += compensations[lane];
+            }
+            return sum + compensation;
+        }
+
+        double sumScalar(const double *data, std::size_t n)
+        {
+            double sum = 0.0;
+            double compensation = 0.0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                addCompensated(sum, compensation, data[i]);
+            }
+            return sum + compensation;
+        }
+
+        double dotScalar(const double *a, const double *b, std::size_t n)
+        {
+            double sum = 0.0;
+            double compensation = 0.0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                addCompensated(sum, compensation, a[i] * b[i]);
+            }
+            return sum + compensation;
+        }
+
+        template <bool Max>
+        double extremeScalar(const double *data, std::size_t n)
+        {
+            double best = data[0];
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (std::isnan(data[i]))
+                {
+                    return data[i];
+                }
+                best = Max ? (data[i] > best ? data[i] : best) : (data[i] < best ? data[i] : best);
+            }
+            return best;
+        }
+
+        std::size_t countNonZeroScalar(const double *data, std::size_t n)
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                count += data[i] != 0.0;
+            }
+            return count;
+        }
+
+        // Branch-free: every position is written, and kept by advancing
+        template <Op O>
+        std::size_t selectScalar(const double *data, double operand, std::uint32_t *out, std::size_t n)
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                out[count] = static_cast<std::uint32_t>(i);
+                count += scalarOp<O>(data[i], operand) != 0.0;
+            }
+            return count;
+        }
+
+        // Appends the positions of the set bits of a comparison mask
+        inline std::size_t appendMask(unsigned mask, std::size_t base, std::uint32_t *out, std::size_t count)
+        {
+            for (; mask != 0; mask &= mask - 1)
+            {
+                out[count++] = static_cast<std::uint32_t>(base + static_cast<std::size_t>(std::countr_zero(mask)));
+            }
+            return count;
+        }
+
+        template <template <Op> class Select>
+        constexpr void addSelects(Kernels &kernels)
+        {
+            kernels.select[static_cast<int>(Op::Less) - FirstComparison] = Select<Op::Less>::run;
+            kernels.select[static_cast<int>(Op::Greater) - FirstComparison] = Select<Op::Greater>::run;
+            kernels.select[static_cast<int>(Op::Equal) - FirstComparison] = Select<Op::Equal>::run;
+        }
+
+        template <Op O>
+        struct ScalarSelect
+        {
+            static std::size_t run(const double *data, double operand, std::uint32_t *out, std::size_t n)
+            {
+                return selectScalar<O>(data, operand, out, n);
+            }
+        };
+
+        template <template <Op, bool, bool> class Kernel, template <Op> class Select>
+        constexpr Kernels makeKernels(VectorMath::Backend backend, ReduceKernel sum, DotKernel dot, ReduceKernel min, ReduceKernel max, CountKernel countNonZero)
+        {
+            Kernels kernels{backend, {}, sum, dot, min, max, countNonZero, {}};
+            addRow<Kernel, Op::Add>(kernels);
+            addRow<Kernel, Op::Subtract>(kernels);
+            addRow<Kernel, Op::Multiply>(kernels);
+            addRow<Kernel, Op::Divide>(kernels);
+            addRow<Kernel, Op::Power>(kernels);
+            addRow<Kernel, Op::Less>(kernels);
+            addRow<Kernel, Op::Greater>(kernels);
+            addRow<Kernel, Op::Equal>(kernels);
+            addSelects<Select>(kernels);
+            return kernels;
+        }
+
+        constexpr Kernels scalarKernels = makeKernels<ScalarBinary, ScalarSelect>(VectorMath::Backend::Scalar, sumScalar, dotScalar, extremeScalar<false>, extremeScalar<true>, countNonZeroScalar);
+
+#ifdef PANGEA_VECTOR_X86
+        // All-ones lanes where the comparison holds
+        template <Op O>
+        inline __m128d compare128(__m128d x, __m128d y)
+        {
+            if constexpr (O == Op::Less)
+                return _mm_cmplt_pd(x, y);
+            else if constexpr (O == Op::Greater)
+                return _mm_cmpgt_pd(x, y);
+            else
+                return _mm_cmpeq_pd(x, y);
+        }
+
+        template <Op O>
+        inline __m128d op128(__m128d x, __m128d y)
+        {
+            if constexpr (O == Op::Add)
+                return _mm_add_pd(x, y);
+            else if constexpr (O == Op::Subtract)
+                return _mm_sub_pd(x, y);
+            else if constexpr (O == Op::Multiply)
+                return _mm_mul_pd(x, y);
+            else if constexpr (O == Op::Divide)
+                return _mm_div_pd(x, y);
+            else
+                return _mm_and_pd(compare128<O>(x, y), _mm_set1_pd(1.0));
+        }
+
+        template <Op O, bool BroadcastA, bool BroadcastB>
+        struct SSE2Binary
+        {
+            static void run(const double *a, const double *b, double *out, std::size_t n)
+            {
+                std::size_t i = 0;
+                if constexpr (O != Op::Power)
+                {
+                    const __m128d splatA = _mm_set1_pd(BroadcastA ? a[0] : 0.0);
+                    const __m128d splatB = _mm_set1_pd(BroadcastB ? b[0] : 0.0);
+                    for (; i + 2 <= n; i += 2)
+                    {
+                        __m128d x = BroadcastA ? splatA : _mm_loadu_pd(a + i);
+                        __m128d y = BroadcastB ? splatB : _mm_loadu_pd(b + i);
+                        _mm_storeu_pd(out + i, op128<O>(x, y));
+                    }
+                }
+                binaryTail<O, BroadcastA, BroadcastB>(a, b, out, i, n);
+            }
+        };
+
+        template <Op O>
+        struct SSE2Select
+        {
+            static std::size_t run(const double *data, double operand, std::uint32_t *out, std::size_t n)
+            {
+                const __m128d y = _mm_set1_pd(operand);
+                std::size_t count = 0;
+                std::size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                {
+                    unsigned mask = static_cast<unsigned>(_mm_movemask_pd(compare128<O>(_mm_loadu_pd(data + i), y)));
+                    count = appendMask(mask, i, out, count);
+                }
+                for (; i < n; ++i)
+                {
+                    out[count] = static_cast<std::uint32_t>(i);
+                    count += scalarOp<O>(data[i], operand) != 0.0;
+                }
+                return count;
+            }
+        };
+
+        inline __m128d abs128(__m128d x)
+        {
+            return _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+        }
+
+        // Per-lane Neumaier step, with the branch replaced by a mask
+        inline void addCompensated128(__m128d &sum, __m128d &compensation, __m128d x)
+        {
+            __m128d total = _mm_add_pd(sum, x);
+            __m128d sumLarger = _mm_cmpge_pd(abs128(sum), abs128(x));
+            __m128d ifSumLarger = _mm_add_pd(_mm_sub_pd(sum, total), x);
+            __m128d ifXLarger = _mm_add_pd(_mm_sub_pd(x, total), sum);
+            compensation = _mm_add_pd(compensation, _mm_or_pd(_mm_and_pd(sumLarger, ifSumLarger), _mm_andnot_pd(sumLarger, ifXLarger)));
+            sum = total;
+        }
+
+        template <bool Dot>
+        double sumSSE2Impl(const double *a, const double *b, std::size_t n)
+        {
+            // Two independent accumulators hide the latency of the adds
+            __m128d sums[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+            __m128d compensations[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                for (int k = 0; k < 2; ++k)
+                {
+                    __m128d x = _mm_loadu_pd(a + i + 2 * k);
+                    if constexpr (Dot)
+                    {
+                        x = _mm_mul_pd(x, _mm_loadu_pd(b + i + 2 * k));
+                    }
+                    addCompensated128(sums[k], compensations[k], x);
+                }
+            }
+
+            double laneSums[4], laneCompensations[4];
+            _mm_storeu_pd(laneSums, sums[0]);
+            _mm_storeu_pd(laneSums + 2, sums[1]);
+            _mm_storeu_pd(laneCompensations, compensations[0]);
+            _mm_storeu_pd(laneCompensations + 2, compensations[1]);
+
+            double sum = 0.0;
+            double compensation = 0.0;
+            for (; i < n; ++i)
+            {
+                addCompensated(sum, compensation, Dot ? a[i] * b[i] : a[i]);
+            }
+            return combineLanes(laneSums, laneCompensations, 4, sum, compensation);
+        }
+
+        double sumSSE2(const double *data, std::size_t n) { return sumSSE2Impl<false>(data, nullptr, n); }
+        double dotSSE2(const double *a, const double *b, std::size_t n) { return sumSSE2Impl<true>(a, b, n); }
+
+        template <bool Max>
+        double extremeSSE2(const double *data, std::size_t n)
+        {
+            __m128d best = _mm_set1_pd(data[0]);
+            __m128d nan = _mm_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                __m128d x = _mm_loadu_pd(data + i);
+                nan = _mm_or_pd(nan, _mm_cmpunord_pd(x, x));
+                best = Max ? _mm_max_pd(best, x) : _mm_min_pd(best, x);
+            }
+            if (_mm_movemask_pd(nan) != 0)
+            {
+                return extremeScalar<Max>(data, n);
+            }
+
+            double lanes[2];
+            _mm_storeu_pd(lanes, best);
+            double result = Max ? (lanes[0] > lanes[1] ? lanes[0] : lanes[1]) : (lanes[0] < lanes[1] ? lanes[0] : lanes[1]);
+            double tail = i < n ? extremeScalar<Max>(data + i, n - i) : result;
+            if (std::isnan(tail))
+            {
+                return tail;
+            }
+            return Max ? (tail > result ? tail : result) : (tail < result ? tail : result);
+        }
+
+        std::size_t countNonZeroSSE2(const double *data, std::size_t n)
+        {
+            std::size_t count = 0;
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                int mask = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(data + i), _mm_setzero_pd()));
+                count += static_cast<std::size_t>((mask & 1) + (mask >> 1));
+            }
+            return count + countNonZeroScalar(data + i, n - i);
+        }
+
+        constexpr Kernels sse2Kernels = makeKernels<SSE2Binary, SSE2Select>(VectorMath::Backend::SSE2, sumSSE2, dotSSE2, extremeSSE2<false>, extremeSSE2<true>, countNonZeroSSE2);
+
+        template <Op O>
+        __attribute__((target("avx2"))) inline __m256d compare256(__m256d x, __m256d y)
+        {
+            if constexpr (O == Op::Less)
+                return _mm256_cmp_pd(x, y, _CMP_LT_OQ);
+            else if constexpr (O == Op::Greater)
+                return _mm256_cmp_pd(x, y, _CMP_GT_OQ);
+            else
+                return _mm256_cmp_pd(x, y, _CMP_EQ_OQ);
+        }
+
+        template <Op O>
+        __attribute__((target("avx2"))) inline __m256d op256(__m256d x, __m256d y)
+        {
+            if constexpr (O == Op::Add)
+                return _mm256_add_pd(x, y);
+            else if constexpr (O == Op::Subtract)
+                return _mm256_sub_pd(x, y);
+            else if constexpr (O == Op::Multiply)
+                return _mm256_mul_pd(x, y);
+            else if constexpr (O == Op::Divide)
+                return _mm256_div_pd(x, y);
+            else
+                return _mm256_and_pd(compare256<O>(x, y), _mm256_set1_pd(1.0));
+        }
+
+        template <Op O, bool BroadcastA, bool BroadcastB>
+        struct AVX2Binary
+        {
+            __attribute__((target("avx2"))) static void run(const double *a, const double *b, double *out, std::size_t n)
+            {
+                std::size_t i = 0;
+                if constexpr (O != Op::Power)
+                {
+                    const __m256d splatA = _mm256_set1_pd(BroadcastA ? a[0] : 0.0);
+                    const __m256d splatB = _mm256_set1_pd(BroadcastB ? b[0] : 0.0);
+                    for (; i + 4 <= n; i += 4)
+                    {
+                        __m256d x = BroadcastA ? splatA : _mm256_loadu_pd(a + i);
+                        __m256d y = BroadcastB ? splatB : _mm256_loadu_pd(b + i);
+                        _mm256_storeu_pd(out + i, op256<O>(x, y));
+                    }
+                }
+                binaryTail<O, BroadcastA, BroadcastB>(a, b, out, i, n);
+            }
+        };
+
+        template <Op O>
+        struct AVX2Select
+        {
+            __attribute__((target("avx2"))) static std::size_t run(const double *data, double operand, std::uint32_t *out, std::size_t n)
+            {
+                const __m256d y = _mm256_set1_pd(operand);
+                std::size_t count = 0;
+                std::size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                {
+                    unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(compare256<O>(_mm256_loadu_pd(data + i), y)));
+                    count = appendMask(mask, i, out, count);
+                }
+                for (; i < n; ++i)
+                {
+                    out[count] = static_cast<std::uint32_t>(i);
+                    count += scalarOp<O>(data[i], operand) != 0.0;
+                }
+                return count;
+            }
+        };
+
+        __attribute__((target("avx2"))) inline __m256d abs256(__m256d x)
+        {
+            return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+        }
+
+        __attribute__((target("avx2"))) inline void addCompensated256(__m256d &sum, __m256d &compensation, __m256d x)
+        {
+            __m256d total = _mm256_add_pd(sum, x);
+            __m256d sumLarger = _mm256_cmp_pd(abs256(sum), abs256(x), _CMP_GE_OQ);
+            __m256d ifSumLarger = _mm256_add_pd(_mm256_sub_pd(sum, total), x);
+            __m256d ifXLarger = _mm256_add_pd(_mm256_sub_pd(x, total), sum);
+            compensation = _mm256_add_pd(compensation, _mm256_blendv_pd(ifXLarger, ifSumLarger, sumLarger));
+            sum = total;
+        }
+
+        template <bool Dot>
+        __attribute__((target("avx2"))) double sumAVX2Impl(const double *a, const double *b, std::size_t n)
+        {
+            __m256d sums[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+            __m256d compensations[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                for (int k = 0; k < 2; ++k)
+                {
+                    __m256d x = _mm256_loadu_pd(a + i + 4 * k);
+                    if constexpr (Dot)
+                    {
+                        x = _mm256_mul_pd(x, _mm256_loadu_pd(b + i + 4 * k));
+                    }
+                    addCompensated256(sums[k], compensations[k], x);
+                }
+            }
+
+            double laneSums[8], laneCompensations[8];
+            _mm256_storeu_pd(laneSums, sums[0]);
+            _mm256_storeu_pd(laneSums + 4, sums[1]);
+            _mm256_storeu_pd(laneCompensations, compensations[0]);
+            _mm256_storeu_pd(laneCompensations + 4, compensations[1]);
+
+            double sum = 0.0;
+            double compensation = 0.0;
+            for (; i < n; ++i)
+            {
+                addCompensated(sum, compensation, Dot ? a[i] * b[i] : a[i]);
+            }
+            return combineLanes(laneSums, laneCompensations, 8, sum, compensation);
+        }
+
+        __attribute__((target("avx2"))) double sumAVX2(const double *data, std::size_t n) { return sumAVX2Impl<false>(data, nullptr, n); }
+        __attribute__((target("avx2"))) double dotAVX2(const double *a, const double *b, std::size_t n) { return sumAVX2Impl<true>(a, b, n); }
+
+        template <bool Max>
+        __attribute__((target("avx2"))) double extremeAVX2(const double *data, std::size_t n)
+        {
+            __m256d best = _mm256_set1_pd(data[0]);
+            __m256d nan = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256d x = _mm256_loadu_pd(data + i);
+                nan = _mm256_or_pd(nan, _mm256_cmp_pd(x, x, _CMP_UNORD_Q));
+                best = Max ? _mm256_max_pd(best, x) : _mm256_min_pd(best, x);
+            }
+            if (_mm256_movemask_pd(nan) != 0)
+            {
+                return extremeScalar<Max>(data, n);
+            }
+
+            double lanes[4];
+            _mm256_storeu_pd(lanes, best);
+            double result = lanes[0];
+            for (int lane = 1; lane < 4; ++lane)
+            {
+                result = Max ? (lanes[lane] > result ? lanes[lane] : result) : (lanes[lane] < result ? lanes[lane] : result);
+            }
+            double tail = i < n ? extremeScalar<Max>(data + i, n - i) : result;
+            if (std::isnan(tail))
+            {
+                return tail;
+            }
+            return Max ? (tail > result ? tail : result) : (tail < result ? tail : result);
+        }
+
+        __attribute__((target("avx2"))) std::size_t countNonZeroAVX2(const double *data, std::size_t n)
+        {
+            std::size_t count = 0;
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256d nonZero = _mm256_cmp_pd(_mm256_loadu_pd(data + i), _mm256_setzero_pd(), _CMP_NEQ_UQ);
+                count += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(_mm256_movemask_pd(nonZero))));
+            }
+            return count + countNonZeroScalar(data + i, n - i);
+        }
+
+        constexpr Kernels avx2Kernels = makeKernels<AVX2Binary, AVX2Select>(VectorMath::Backend::AVX2, sumAVX2, dotAVX2, extremeAVX2<false>, extremeAVX2<true>, countNonZeroAVX2);
+#endif
+
+        const Kernels *kernelsFor(VectorMath::Backend backend)
+        {
+            switch (backend)
+            {
+#ifdef PANGEA_VECTOR_X86
+            case VectorMath::Backend::SSE2:
+                return &sse2Kernels;
+            case VectorMath::Backend::AVX2:
+                return &avx2Kernels;
+#endif
+            case VectorMath::Backend::Scalar:
+            default:
+                return &scalarKernels;
+            }
+        }
+
+        const Kernels *&activeKernels()
+        {
+            static const Kernels *active = kernelsFor(VectorMath::getBestBackend());
+            return active;
+        }
+    } // namespace
+
+    void VectorMath::apply(Op op, const double *a, bool broadcastA, const double *b, bool broadcastB, double *out, std::size_t n)
+    {
+        if (broadcastA && broadcastB)
+        {
+            // Nothing to vectorize: one result repeated
+            double value;
+            scalarKernels.binary[static_cast<int>(op)][0](a, b, &value, 1);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                out[i] = value;
+            }
+            return;
+        }
+
+        int mode = broadcastA ? 1 : broadcastB ? 2 : 0;
+        activeKernels()->binary[static_cast<int>(op)][mode](a, b, out, n);
+    }
+
+    std::size_t VectorMath::select(Op op, const double *data, double operand, std::uint32_t *out, std::size_t n)
+    {
+        int comparison = static_cast<int>(op) - FirstComparison;
+        if (comparison < 0)
+        {
+            throw std::runtime_error("VectorMath::select expects a comparison");
+        }
+        return activeKernels()->select[comparison](data, operand, out, n);
+    }
+
+    double VectorMath::sum(const double *data, std::size_t n)
+    {
+        return activeKernels()->sum(data, n);
+    }
+
+    double VectorMath::dot(const double *a, const double *b, std::size_t n)
+    {
+        return activeKernels()->dot(a, b, n);
+    }
+
+    double VectorMath::min(const double *data, std::size_t n)
+    {
+        return activeKernels()->min(data, n);
+    }
+
+    double VectorMath::max(const double *data, std::size_t n)
+    {
+        return activeKernels()->max(data, n);
+    }
+
+    std::size_t VectorMath::argmax(const double *data, std::size_t n)
+    {
+        // Find the maximum (or a NaN) with the vector kernel, then the first
+        // element matching it; the second scan usually stops early
+        double best = max(data, n);
+        bool nan = std::isnan(best);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (nan ? std::isnan(data[i]) : data[i] == best)
+            {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    std::size_t VectorMath::countNonZero(const double *data, std::size_t n)
+    {
+        return activeKernels()->countNonZero(data, n);
+    }
+
+    VectorMath::Backend VectorMath::getBackend()
+    {
+        return activeKernels()->backend;
+    }
+
+    void VectorMath::setBackend(Backend backend)
+    {
+        if (!isSupported(backend))
+        {
+            throw std::runtime_error("Vector backend not supported on this CPU: " + getBackendName(backend));
+        }
+        activeKernels() = kernelsFor(backend);
+    }
+
+    bool VectorMath::isSupported(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Scalar:
+            return true;
+#ifdef PANGEA_VECTOR_X86
+        case Backend::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Backend::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+        }
+    }
+
+    VectorMath::Backend VectorMath::getBestBackend()
+    {
+        if (isSupported(Backend::AVX2))
+        {
+            return Backend::AVX2;
+        }
+        if (isSupported(Backend::SSE2))
+        {
+            return Backend::SSE2;
+        }
+        return Backend::Scalar;
+    }
+
+    std::string VectorMath::getBackendName(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Scalar:
+            return "scalar";
+        case Backend::SSE2:
+            return "sse2";
+        case Backend::AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+        }
+    }
+
+} // namespace pangea
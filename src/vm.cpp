@@ -0,0 +1,183 @@
+#include "interpreter.hpp"
+#include <stdexcept>
+
+namespace pangea
+{
+
+    void Interpreter::compile(int from, int to)
+    {
+        bytecode_.clear();
+        bytecode_.firstWord = from;
+        bytecode_.blocks.resize(to > from ? to - from : 0);
+        std::unordered_map<const FunctionEntry *, std::uint32_t> functionSlots;
+
+        // Argument phrases of special forms still to be compiled into
+        // blocks; nested special forms add theirs as they are reached
+        std::vector<PhraseRef> phrases;
+
+        auto emitCall = [&](std::vector<Instruction> &code, OpCode op, const FunctionEntry &entry, int site)
+        {
+            auto slot = functionSlots.find(&entry);
+            if (slot == functionSlots.end())
+            {
+                bytecode_.functions.push_back(&entry);
+                slot = functionSlots.emplace(&entry, static_cast<std::uint32_t>(bytecode_.functions.size() - 1)).first;
+            }
+            code.push_back({op, static_cast<std::uint32_t>(entry.getArity()), slot->second, static_cast<std::uint32_t>(site)});
+        };
+
+        // Prefix phrases become postfix code with the same pending-call
+        // stack the tree-walker uses: a call is emitted once its last
+        // argument has been emitted
+        std::vector<OpenPhrase> &pending = pendingCalls_;
+        const std::size_t callBase = pending.size();
+
+        auto compileRange = [&](std::vector<Instruction> &code, int first, int last)
+        {
+            for (int i = first; i < last; ++i)
+            {
+                // Only the value of the last top-level phrase is kept
+                if (i > first && pending.size() == callBase)
+                {
+                    code.push_back({OpCode::Pop, 0, 0, 0});
+                }
+
+                const FunctionEntry *entry = functionAt(i);
+                if (entry && entry->isSpecialForm())
+                {
+                    // The form's arguments become blocks of their own and
+                    // the form itself a single value in this code
+                    int next = i + 1;
+                    for (int k = 0; k < entry->getArity(); ++k)
+                    {
+                        if (next >= last)
+                        {
+                            throw std::runtime_error("Missing arguments for function: " + std::string(words_[i]));
+                        }
+                        phrases.push_back({next, phraseLengths_[next]});
+                        next += phraseLengths_[next];
+                    }
+                    emitCall(code, OpCode::CallSpecial, *entry, i);
+                    i = next - 1;
+                }
+                else if (entry && entry->getArity() > 0)
+                {
+                    if (pending.size() >= maxDepth_)
+                    {
+                        throw std::runtime_error("Maximum nesting depth exceeded (" + std::to_string(maxDepth_) + ")");
+                    }
+                    pending.push_back({i, entry->getArity()});
+                    continue;
+                }
+                else if (entry)
+                {
+                    emitCall(code, OpCode::Call, *entry, i);
+                }
+                else
+                {
+                    // Literals were decoded into the constant pool at parse time
+                    code.push_back({OpCode::PushConst, 0, wordConstants_[i], 0});
+                }
+
+                while (pending.size() > callBase && --pending.back().remaining == 0)
+                {
+                    emitCall(code, OpCode::Call, *functionAt(pending.back().start), pending.back().start);
+                    pending.pop_back();
+                }
+            }
+
+            if (pending.size() > callBase)
+            {
+                throw std::runtime_error("Missing arguments for function: " + std::string(words_[pending.back().start]));
+            }
+        };
+
+        try
+        {
+            compileRange(bytecode_.code, from, to);
+
+            while (!phrases.empty())
+            {
+                PhraseRef phrase = phrases.back();
+                phrases.pop_back();
+                Bytecode::Block &block = bytecode_.blocks[phrase.start - from];
+                block.begin = static_cast<std::uint32_t>(bytecode_.phraseCode.size());
+                compileRange(bytecode_.phraseCode, phrase.start, phrase.start + phrase.length);
+                block.end = static_cast<std::uint32_t>(bytecode_.phraseCode.size());
+            }
+        }
+        catch (...)
+        {
+            pending.resize(callBase);
+            bytecode_.clear();
+            throw;
+        }
+    }
+
+    Value Interpreter::runBytecode()
+    {
+        return runBytecode(bytecode_.code.data(), bytecode_.code.data() + bytecode_.code.size());
+    }
+
+    Value Interpreter::runBytecode(const Instruction *first, const Instruction *last)
+    {
+        // The operand stack is reused across runs and only ever grows
+        const std::size_t operandBase = operandStack_.size();
+
+        try
+        {
+            for (const Instruction *instruction = first; instruction != last; ++instruction)
+            {
+                switch (instruction->op)
+                {
+                case OpCode::PushConst:
+                    operandStack_.push_back(constants_[instruction->operand]);
+                    break;
+
+                case OpCode::Call:
+                {
+                    Value result = callWithStackArgs(*bytecode_.functions[instruction->operand], instruction->argc, instruction->site);
+                    operandStack_.push_back(std::move(result));
+                    break;
+                }
+
+                case OpCode::CallSpecial:
+                {
+                    Value result = callSpecialForm(*bytecode_.functions[instruction->operand], instruction->site);
+                    operandStack_.push_back(std::move(result));
+                    break;
+                }
+
+                case OpCode::Pop:
+                    operandStack_.pop_back();
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            operandStack_.resize(operandBase);
+            throw;
+        }
+
+        if (operandStack_.size() == operandBase)
+        {
+            return Value();
+        }
+        Value result = std::move(operandStack_.back());
+        operandStack_.resize(operandBase);
+        return result;
+    }
+
+    Value Interpreter::evaluate(const PhraseRef &phrase)
+    {
+        if (executionMode_ == ExecutionMode::Bytecode)
+        {
+            const Bytecode::Block &block = bytecode_.blocks[phrase.start - bytecode_.firstWord];
+            const Instruction *code = bytecode_.phraseCode.data();
+            return runBytecode(code + block.begin, code + block.end);
+        }
+        return wordExec(phrase.start, phrase.start + phrase.length - 1);
+    }
+
+} // namespace pangea
@@ -1,10 +1,63 @@
 #include <catch2/catch_test_macros.hpp>
 #include "interpreter.hpp"
 #include "value.hpp"
+#include "object.hpp"
+#include "output_sink.hpp"
+#include "input_source.hpp"
+#include "mapped_file.hpp"
+#include "csv_reader.hpp"
+#include "function_entry.hpp"
+#include "table.hpp"
+#include "flat_map.hpp"
+#include "vector_math.hpp"
 #include "parser.hpp"
+#include "scanner.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 using namespace pangea;
 
+// Counts heap allocations so tests can check allocation-free paths
+static std::size_t allocationCount = 0;
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC cannot tell these replacements pair malloc with free
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
 TEST_CASE("Value construction and type checking", "[value]")
 {
     SECTION("Number values")
@@ -53,6 +106,42 @@ TEST_CASE("Value construction and type checking", "[value]")
     }
 }
 
+TEST_CASE("Value representation", "[value]")
+{
+    SECTION("Values are one NaN-boxed word")
+    {
+        REQUIRE(sizeof(Value) == 8);
+        REQUIRE(Value().isNull());
+        REQUIRE(Value(-0.0).isNumber());
+        REQUIRE(Value(std::numeric_limits<double>::infinity()).asNumber() == std::numeric_limits<double>::infinity());
+        REQUIRE(std::isnan(Value(-std::numeric_limits<double>::quiet_NaN()).asNumber()));
+        REQUIRE(Value(false).isBoolean());
+        REQUIRE(Value(false).getType() == Value::Type::Boolean);
+        REQUIRE(Value("text").getType() == Value::Type::String);
+    }
+
+    SECTION("Copies share heap storage until mutated")
+    {
+        Value original(std::vector<Value>{Value(1.0), Value("two")});
+        Value copy = original;
+        REQUIRE(original.isShared());
+        REQUIRE(copy == original);
+
+        copy.asArrayMutable().push_back(Value(3.0));
+        REQUIRE_FALSE(original.isShared());
+        REQUIRE(original.asArray().size() == 2);
+        REQUIRE(copy.asArray().size() == 3);
+    }
+
+    SECTION("Moves leave null behind")
+    {
+        Value source("moved");
+        Value target = std::move(source);
+        REQUIRE(target.asString() == "moved");
+        REQUIRE(source.isNull());
+    }
+}
+
 TEST_CASE("Value equality", "[value]")
 {
     SECTION("Number equality")
@@ -83,6 +172,291 @@ TEST_CASE("Value equality", "[value]")
     }
 }
 
+TEST_CASE("Integers", "[value][integer]")
+{
+    SECTION("Integers are inline numbers")
+    {
+        Value small(std::int64_t(-42));
+        REQUIRE(small.isInteger());
+        REQUIRE(small.isNumber());
+        REQUIRE(small.getType() == Value::Type::Number);
+        REQUIRE(small.asInteger() == -42);
+        REQUIRE(small.asNumber() == -42.0);
+        REQUIRE(Value(Value::MaxInteger).asInteger() == Value::MaxInteger);
+        REQUIRE(Value(Value::MinInteger).asInteger() == Value::MinInteger);
+        REQUIRE_FALSE(Value(42.0).isInteger());
+        REQUIRE_THROWS(Value(42.0).asInteger());
+        REQUIRE_FALSE(Value(true).isInteger());
+        REQUIRE_FALSE(Value().isInteger());
+    }
+
+    SECTION("Values outside the inline range become doubles")
+    {
+        Value large(Value::MaxInteger + 1);
+        REQUIRE_FALSE(large.isInteger());
+        REQUIRE(large.asNumber() == static_cast<double>(Value::MaxInteger + 1));
+    }
+
+    SECTION("Integers equal the doubles they convert to")
+    {
+        REQUIRE(Value(std::int64_t(3)) == Value(3.0));
+        REQUIRE(Value(std::int64_t(3)) == Value(std::int64_t(3)));
+        REQUIRE(Value(std::int64_t(3)) != Value(3.5));
+        REQUIRE(Value(std::int64_t(-7)).toString() == "-7");
+        REQUIRE(Value(Value::MinInteger).toString() == std::to_string(Value::MinInteger));
+    }
+
+    SECTION("Whole literals are integers")
+    {
+        REQUIRE(Parser::decodeLiteral("42")->isInteger());
+        REQUIRE(Parser::decodeLiteral("-17")->asInteger() == -17);
+        REQUIRE(Parser::decodeLiteral("+7")->asInteger() == 7);
+        REQUIRE_FALSE(Parser::decodeLiteral("4.0")->isInteger());
+        REQUIRE_FALSE(Parser::decodeLiteral("1e3")->isInteger());
+        REQUIRE(std::signbit(Parser::decodeLiteral("-0")->asNumber()));
+        REQUIRE_FALSE(Parser::decodeLiteral("99999999999999999999")->isInteger());
+    }
+
+    SECTION("Arithmetic keeps integers while they fit")
+    {
+        Interpreter interpreter;
+        REQUIRE(interpreter.execute("plus 2 3").asInteger() == 5);
+        REQUIRE(interpreter.execute("minus 2 3").asInteger() == -1);
+        REQUIRE(interpreter.execute("times 6 7").asInteger() == 42);
+        REQUIRE(interpreter.execute("divide 12 4").asInteger() == 3);
+        REQUIRE(interpreter.execute("divide 7 2").asNumber() == 3.5);
+        REQUIRE(interpreter.execute("power 2 10").asInteger() == 1024);
+        REQUIRE(interpreter.execute("power 2 -1").asNumber() == 0.5);
+        REQUIRE_FALSE(interpreter.execute("plus 2 0.5").isInteger());
+        REQUIRE(interpreter.execute("less 2 3").asBoolean());
+        REQUIRE(interpreter.execute("greater -2 -3").asBoolean());
+        REQUIRE(interpreter.execute("string times 12 12").asString() == "144");
+    }
+
+    SECTION("Overflow promotes to double")
+    {
+        Interpreter interpreter;
+        Value sum = interpreter.execute("plus 562949953421311 1");
+        REQUIRE_FALSE(sum.isInteger());
+        REQUIRE(sum.asNumber() == 562949953421312.0);
+
+        Value product = interpreter.execute("times 4294967296 4294967296");
+        REQUIRE_FALSE(product.isInteger());
+        REQUIRE(product.asNumber() == 18446744073709551616.0);
+
+        REQUIRE(interpreter.execute("power 10 30").asNumber() == 1e30);
+    }
+
+    SECTION("Counters and indices are integers")
+    {
+        Interpreter interpreter;
+        REQUIRE(interpreter.execute("length \"abc\"").asInteger() == 3);
+        REQUIRE(interpreter.execute("times_loop 4 index").asInteger() == 3);
+        REQUIRE(interpreter.execute("times_loop 2.5 index").asInteger() == 2);
+        REQUIRE(interpreter.execute("each range 5 8 value").asInteger() == 7);
+        REQUIRE(interpreter.execute("each range 0.5 2 value").asNumber() == 1.5);
+        REQUIRE(interpreter.execute("get set set set array 0 10 1 20 2 30 2").asNumber() == 30.0);
+        REQUIRE(interpreter.execute("get set set set array 0 10 1 20 2 30 1.9").asNumber() == 20.0);
+        REQUIRE(interpreter.execute("get set set set array 0 10 1 20 2 30 -1").isNull());
+        REQUIRE(interpreter.execute("length set set set set array 0 10 1 20 2 30 3 40").asInteger() == 4);
+        REQUIRE_THROWS(interpreter.execute("set set set set array 0 10 1 20 2 30 -1 40"));
+        REQUIRE_THROWS(interpreter.execute("set set set set array 0 10 1 20 2 30 0.5 40"));
+    }
+}
+
+TEST_CASE("Value formatting", "[value][format]")
+{
+    SECTION("Numbers use the shortest round-trip text")
+    {
+        REQUIRE(Value(0.1).toString() == "0.1");
+        REQUIRE(Value(2.5).toString() == "2.5");
+        REQUIRE(Value(1.0 / 3.0).toString() == "0.3333333333333333");
+        REQUIRE(std::stod(Value(1.0 / 3.0).toString()) == 1.0 / 3.0);
+        REQUIRE(Value(1e-7).toString() == "1e-07");
+        REQUIRE(Value(1e300).toString() == "1e+300");
+        REQUIRE(Value(-0.0).toString() == "0");
+        REQUIRE(Value(std::numeric_limits<double>::infinity()).toString() == "inf");
+        REQUIRE(Value(std::numeric_limits<double>::quiet_NaN()).toString() == "nan");
+    }
+
+    SECTION("Whole doubles print in full")
+    {
+        REQUIRE(Value(42.0).toString() == "42");
+        REQUIRE(Value(1e15).toString() == "1000000000000000");
+        REQUIRE(Value(-1e20).toString() == "-100000000000000000000");
+        REQUIRE(Value(1e21).toString() == "1e+21");
+    }
+
+    SECTION("writeTo streams the same text as toString")
+    {
+        Object object;
+        object.set("name", Value("pangea"));
+        object.set("list", Value(std::vector<Value>{Value(std::int64_t(1)), Value(0.25), Value(), Value(true)}));
+        object.set("packed", Value(std::vector<double>{1.5, -2.0}));
+        Value value(object);
+
+        StringSink sink;
+        value.writeTo(sink);
+        REQUIRE(sink.str() == value.toString());
+        REQUIRE(sink.str() == "{\"name\": pangea, \"list\": [1, 0.25, null, true], \"packed\": [1.5, -2]}");
+    }
+
+    SECTION("Sinks pass text larger than their buffer through")
+    {
+        std::vector<double> numbers(100000);
+        for (std::size_t i = 0; i < numbers.size(); ++i)
+        {
+            numbers[i] = static_cast<double>(i) + 0.5;
+        }
+        Value array(numbers);
+
+        std::ostringstream stream;
+        array.print(stream);
+        REQUIRE(stream.str() == array.toString());
+        REQUIRE(stream.str().substr(0, 16) == "[0.5, 1.5, 2.5, ");
+
+        StringSink sink;
+        sink.write(std::string(10000, 'x'));
+        sink.put('y');
+        REQUIRE(sink.str() == std::string(10000, 'x') + "y");
+    }
+
+#if !defined(_WIN32)
+    SECTION("print and println write to standard output")
+    {
+        // Standard output is pointed at a file while the run writes to it
+        const auto path = std::filesystem::temp_directory_path() / "pangea_stdout.txt";
+        std::fflush(stdout);
+        int saved = ::dup(1);
+        int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        ::dup2(file, 1);
+        ::close(file);
+        {
+            Interpreter interpreter;
+            std::cout << "before ";
+            interpreter.execute("print 0.1 println divide 1 4");
+        }
+        std::fflush(stdout);
+        ::dup2(saved, 1);
+        ::close(saved);
+
+        std::ifstream written(path);
+        std::string text((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        REQUIRE(text == "before 0.10.25\n");
+    }
+
+    SECTION("File sinks write blocks to their descriptor")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "pangea_sink.txt";
+        const std::string text(200000, 'z');
+        {
+            FileSink sink(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600), 64 * 1024, true);
+            sink.write("head ");
+            sink.write(text);
+            sink.put('!');
+        }
+        std::ifstream written(path);
+        std::string received((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        REQUIRE(received == "head " + text + "!");
+
+        REQUIRE_THROWS_AS(FileSink(-1).write(std::string(5000, 'x')), std::runtime_error);
+    }
+#endif
+}
+
+namespace
+{
+    // Records what reaches the destination and how often it was flushed
+    class RecordingSink : public OutputSink
+    {
+    public:
+        std::string received;
+        int flushes = 0;
+
+        explicit RecordingSink(std::size_t capacity) : OutputSink(capacity) {}
+        ~RecordingSink() override { drain(); }
+
+        void flush() override
+        {
+            drain();
+            ++flushes;
+        }
+
+    protected:
+        void consume(std::string_view bytes) override { received.append(bytes); }
+    };
+} // namespace
+
+TEST_CASE("Output sink", "[interpreter][output]")
+{
+    Interpreter interpreter;
+    auto owned = std::make_unique<RecordingSink>(64);
+    RecordingSink &sink = *owned;
+    interpreter.setOutput(std::move(owned));
+
+    SECTION("Line flushes after every println")
+    {
+        interpreter.setFlushPolicy(Interpreter::FlushPolicy::Line);
+        interpreter.execute("println 1 print 2 println 3");
+        REQUIRE(sink.received == "1\n23\n");
+        REQUIRE(sink.flushes == 3); // Two lines and the end of the run
+    }
+
+    SECTION("Block flushes once the run ends")
+    {
+        interpreter.execute("println 1 println 2");
+        REQUIRE(sink.received == "1\n2\n");
+        REQUIRE(sink.flushes == 1);
+
+        REQUIRE_THROWS(interpreter.execute("print \"partial\" divide 1 0"));
+        REQUIRE(sink.received == "1\n2\npartial");
+    }
+
+    SECTION("Explicit waits for a full buffer or flush")
+    {
+        interpreter.setFlushPolicy(Interpreter::FlushPolicy::Explicit);
+        interpreter.execute("times_loop 100 print \"x\"");
+        REQUIRE(sink.received == std::string(64, 'x'));
+        REQUIRE(sink.flushes == 0);
+
+        interpreter.execute("flush");
+        REQUIRE(sink.received == std::string(100, 'x'));
+        REQUIRE(sink.flushes == 1);
+    }
+
+    SECTION("Replacing the sink flushes the old one")
+    {
+        std::ostringstream stream;
+        interpreter.setOutput(std::make_unique<StreamSink>(stream));
+        interpreter.setFlushPolicy(Interpreter::FlushPolicy::Explicit);
+        interpreter.execute("print \"old\"");
+        REQUIRE(stream.str().empty());
+
+        auto replacement = std::make_unique<StringSink>();
+        StringSink &text = *replacement;
+        interpreter.setOutput(std::move(replacement));
+        REQUIRE(stream.str() == "old");
+
+        interpreter.execute("print \"new\"");
+        REQUIRE(text.str() == "new");
+    }
+
+    SECTION("Destroying the interpreter flushes")
+    {
+        std::ostringstream stream;
+        {
+            Interpreter scoped;
+            scoped.setOutput(std::make_unique<StreamSink>(stream));
+            scoped.setFlushPolicy(Interpreter::FlushPolicy::Explicit);
+            scoped.execute("println \"bye\"");
+            REQUIRE(stream.str().empty());
+        }
+        REQUIRE(stream.str() == "bye\n");
+    }
+}
+
 TEST_CASE("Parser tokenization", "[parser]")
 {
     SECTION("Simple tokens")
@@ -119,6 +493,110 @@ TEST_CASE("Parser tokenization", "[parser]")
     }
 }
 
+TEST_CASE("Single-pass tokenizer", "[parser]")
+{
+    SECTION("Tokens view the source with line and column")
+    {
+        std::string source = "print \"a # b\" # comment\n  plus 1 2";
+        auto tokens = Parser::tokenize(source);
+        REQUIRE(tokens.size() == 5);
+        REQUIRE(tokens[0].text(source) == "print");
+        REQUIRE(tokens[1].text(source) == "\"a # b\"");
+        REQUIRE(tokens[1].line == 1);
+        REQUIRE(tokens[1].column == 7);
+        REQUIRE(tokens[2].text(source) == "plus");
+        REQUIRE(tokens[2].line == 2);
+        REQUIRE(tokens[2].column == 3);
+        REQUIRE(tokens[4].text(source) == "2");
+    }
+
+    SECTION("Hash only starts a comment after whitespace")
+    {
+        auto tokens = Parser::parseCode("add#2 5 3 # arithmetic\n# full line\n\"x\"#y");
+        REQUIRE(tokens == std::vector<std::string>{"add#2", "5", "3", "\"x\"", "#y"});
+    }
+
+    SECTION("Escaped quotes stay inside strings")
+    {
+        auto tokens = Parser::parseCode("print \"say \\\"hi\\\" # no comment\" next");
+        REQUIRE(tokens.size() == 3);
+        REQUIRE(tokens[1] == "\"say \\\"hi\\\" # no comment\"");
+        REQUIRE(tokens[2] == "next");
+    }
+
+    SECTION("Quotes split adjacent words")
+    {
+        auto tokens = Parser::parseCode("abc\"def\"ghi");
+        REQUIRE(tokens == std::vector<std::string>{"abc", "\"def\"", "ghi"});
+    }
+}
+
+TEST_CASE("Scanner backends agree", "[parser][scanner]")
+{
+    // Long enough runs that the vector loops and their scalar tails both run
+    std::string source;
+    for (int i = 0; i < 40; ++i)
+    {
+        source += "println plus \"item # " + std::to_string(i) + " \\\" q\" add#2\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t 3.5";
+        source += (i % 3 == 0) ? " # trailing comment with \"quotes\"\r\n" : "\n";
+        source += std::string(i, ' ') + "very_long_identifier_that_spans_more_than_thirty_two_bytes_" + std::to_string(i) + "\n";
+    }
+
+    const Scanner::Backend original = Scanner::getBackend();
+    Scanner::setBackend(Scanner::Backend::Scalar);
+    const auto expected = Parser::tokenize(source);
+    REQUIRE(expected.size() == 40 * 6);
+
+    for (auto backend : {Scanner::Backend::SSE2, Scanner::Backend::AVX2})
+    {
+        if (!Scanner::isSupported(backend))
+        {
+            continue;
+        }
+        INFO(Scanner::getBackendName(backend));
+        Scanner::setBackend(backend);
+        const auto tokens = Parser::tokenize(source);
+        REQUIRE(tokens.size() == expected.size());
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            REQUIRE(tokens[i].text(source) == expected[i].text(source));
+            REQUIRE(tokens[i].line == expected[i].line);
+            REQUIRE(tokens[i].column == expected[i].column);
+        }
+    }
+
+    Scanner::setBackend(original);
+}
+
+TEST_CASE("Literal decoding", "[parser]")
+{
+    SECTION("Numbers")
+    {
+        REQUIRE(Parser::decodeLiteral("42")->asNumber() == 42.0);
+        REQUIRE(Parser::decodeLiteral("3.25")->asNumber() == 3.25);
+        REQUIRE(Parser::decodeLiteral("-.5")->asNumber() == -0.5);
+        REQUIRE(Parser::decodeLiteral("+7")->asNumber() == 7.0);
+        REQUIRE(Parser::decodeLiteral("1e3")->asNumber() == 1000.0);
+    }
+
+    SECTION("Strings, booleans and null")
+    {
+        REQUIRE(Parser::decodeLiteral("\"text\"")->asString() == "text");
+        REQUIRE(Parser::decodeLiteral("true")->asBoolean() == true);
+        REQUIRE(Parser::decodeLiteral("false")->asBoolean() == false);
+        REQUIRE(Parser::decodeLiteral("null")->isNull());
+    }
+
+    SECTION("Identifiers are not literals")
+    {
+        REQUIRE_FALSE(Parser::decodeLiteral("variable").has_value());
+        REQUIRE_FALSE(Parser::decodeLiteral("3abc").has_value());
+        REQUIRE_FALSE(Parser::decodeLiteral("-").has_value());
+        REQUIRE(Parser::parseValue("variable").isNull());
+        REQUIRE(Parser::parseValue("2.5").asNumber() == 2.5);
+    }
+}
+
 TEST_CASE("Basic interpreter execution", "[interpreter]")
 {
     Interpreter interpreter;
@@ -237,3 +715,1459 @@ TEST_CASE("Error handling", "[interpreter]")
         // The behavior here depends on implementation - could be 0 or throw
     }
 }
+
+TEST_CASE("Bytecode and tree-walking modes agree", "[interpreter][bytecode]")
+{
+    const std::vector<std::string> programs = {
+        "plus 2 3",
+        "plus times 2 3 4",
+        "minus divide 20 4 power 2 2",
+        "plus \"hello\" \" world\"",
+        "if less 3 5 \"yes\" \"no\"",
+        "and or false true not false",
+        "if false plus 1 plus 2 3 times 2 2",
+        "times_loop 3 plus 1 1",
+        "or true 1",
+        "length \"hello\"",
+        "type type 42",
+        "equal plus 1 1 2"};
+
+    for (const auto &program : programs)
+    {
+        Interpreter walker;
+        walker.setExecutionMode(Interpreter::ExecutionMode::TreeWalk);
+        Interpreter vm;
+        REQUIRE(vm.getExecutionMode() == Interpreter::ExecutionMode::Bytecode);
+
+        INFO(program);
+        REQUIRE(vm.execute(program) == walker.execute(program));
+    }
+}
+
+TEST_CASE("Bytecode compilation", "[interpreter][bytecode]")
+{
+    Interpreter interpreter;
+
+    SECTION("Calls follow their arguments")
+    {
+        interpreter.execute("plus times 2 3 4");
+        const auto &code = interpreter.getBytecode().code;
+        REQUIRE(code.size() == 5);
+        REQUIRE(code[0].op == OpCode::PushConst);
+        REQUIRE(code[1].op == OpCode::PushConst);
+        REQUIRE(code[2].op == OpCode::Call);
+        REQUIRE(code[2].argc == 2);
+        REQUIRE(code[3].op == OpCode::PushConst);
+        REQUIRE(code[4].op == OpCode::Call);
+        REQUIRE(interpreter.getBytecode().functions.size() == 2);
+    }
+
+    SECTION("Top-level phrases run in sequence")
+    {
+        Value result = interpreter.execute("plus 1 2 times 3 4");
+        REQUIRE(result.isNumber());
+        REQUIRE(result.asNumber() == 12.0);
+    }
+
+    SECTION("Missing arguments are reported")
+    {
+        REQUIRE_THROWS_AS(interpreter.execute("plus 1"), std::runtime_error);
+
+        interpreter.setExecutionMode(Interpreter::ExecutionMode::TreeWalk);
+        REQUIRE_THROWS_AS(interpreter.execute("plus 1"), std::runtime_error);
+    }
+}
+
+TEST_CASE("Special forms", "[interpreter][special]")
+{
+    auto output = [](Interpreter &interpreter, const std::string &program)
+    {
+        auto sink = std::make_unique<StringSink>();
+        StringSink &captured = *sink;
+        interpreter.setOutput(std::move(sink));
+        interpreter.execute(program);
+        return captured.str();
+    };
+
+    for (auto mode : {Interpreter::ExecutionMode::Bytecode, Interpreter::ExecutionMode::TreeWalk})
+    {
+        Interpreter interpreter;
+        interpreter.setExecutionMode(mode);
+        INFO((mode == Interpreter::ExecutionMode::Bytecode ? "bytecode" : "tree-walk"));
+
+        SECTION("if evaluates only the chosen branch")
+        {
+            REQUIRE(output(interpreter, "if less 1 2 print \"then\" print \"else\"") == "then");
+            REQUIRE(output(interpreter, "if false print \"then\" print \"else\"") == "else");
+            REQUIRE(interpreter.execute("plus if true if false 1 2 3 10").asNumber() == 12.0);
+            REQUIRE(interpreter.execute("if true 1 never_evaluated").asNumber() == 1.0);
+        }
+
+        SECTION("and and or short-circuit")
+        {
+            REQUIRE(output(interpreter, "and false print \"x\"") == "");
+            REQUIRE(output(interpreter, "or true print \"x\"") == "");
+            REQUIRE(interpreter.execute("and true not false").asBoolean());
+            REQUIRE_FALSE(interpreter.execute("or false false").asBoolean());
+            REQUIRE_THROWS(output(interpreter, "and true print \"x\""));
+        }
+
+        SECTION("Loop bodies run once per iteration")
+        {
+            REQUIRE(output(interpreter, "times_loop 3 print \"x\"") == "xxx");
+            REQUIRE(output(interpreter, "times_loop 0 print \"x\"") == "");
+            REQUIRE(interpreter.execute("times_loop 2 plus 1 1").asNumber() == 2.0);
+            REQUIRE(output(interpreter, "each set set array 0 1 1 2 print \"e\"") == "ee");
+            REQUIRE(output(interpreter, "each range 0 4 times_loop 2 print \".\"") == "........");
+            REQUIRE(interpreter.execute("each array 1").isNull());
+        }
+
+        SECTION("Missing arguments of a special form are reported")
+        {
+            REQUIRE_THROWS_AS(interpreter.execute("if true 1"), std::runtime_error);
+            REQUIRE_THROWS_AS(interpreter.execute("times_loop 2 plus 1"), std::runtime_error);
+        }
+    }
+
+    SECTION("Arguments compile into separate blocks")
+    {
+        Interpreter interpreter;
+        interpreter.execute("plus if true 1 2 3");
+        const auto &bytecode = interpreter.getBytecode();
+        REQUIRE(bytecode.code.size() == 3);
+        REQUIRE(bytecode.code[0].op == OpCode::CallSpecial);
+        REQUIRE(bytecode.code[0].argc == 3);
+        REQUIRE(bytecode.code[1].op == OpCode::PushConst);
+        REQUIRE(bytecode.code[2].op == OpCode::Call);
+        REQUIRE(bytecode.phraseCode.size() == 3);
+        REQUIRE_THROWS(interpreter.findFunction("if")->invoke(ValueSpan()));
+    }
+}
+
+TEST_CASE("Loop engine", "[interpreter][loops]")
+{
+    auto output = [](Interpreter &interpreter, const std::string &program)
+    {
+        auto sink = std::make_unique<StringSink>();
+        StringSink &captured = *sink;
+        interpreter.setOutput(std::move(sink));
+        interpreter.execute(program);
+        return captured.str();
+    };
+
+    for (auto mode : {Interpreter::ExecutionMode::Bytecode, Interpreter::ExecutionMode::TreeWalk})
+    {
+        Interpreter interpreter;
+        interpreter.setExecutionMode(mode);
+        INFO((mode == Interpreter::ExecutionMode::Bytecode ? "bytecode" : "tree-walk"));
+
+        SECTION("Loops expose their index, key and value")
+        {
+            REQUIRE(output(interpreter, "times_loop 4 print index") == "0123");
+            REQUIRE(output(interpreter, "times_loop 3 print value") == "012");
+            REQUIRE(output(interpreter, "each set set array 0 \"a\" 1 \"b\" print plus key value") == "0a1b");
+            REQUIRE(output(interpreter, "each set set object \"x\" 1 \"y\" 2 print plus key value") == "x1y2");
+            REQUIRE(output(interpreter, "each map range 0 3 \"times\" 2 print value") == "024");
+            REQUIRE(output(interpreter, "times_loop 2 times_loop 2 print plus index \",\"") == "0,1,0,1,");
+            REQUIRE(interpreter.execute("times_loop 5 times index index").asNumber() == 16.0);
+        }
+
+        SECTION("stop ends the innermost loop after its body")
+        {
+            REQUIRE(output(interpreter, "times_loop 100 if equal index 3 stop print index") == "012");
+            REQUIRE(output(interpreter, "times_loop 2 times_loop 5 if equal index 1 stop print index") == "00");
+            REQUIRE(output(interpreter, "each range 0 1e15 if equal value 2 stop print value") == "01");
+        }
+
+        SECTION("Loop variables only exist inside loops")
+        {
+            REQUIRE_THROWS(interpreter.execute("index"));
+            REQUIRE_THROWS(interpreter.execute("stop"));
+            REQUIRE_THROWS(interpreter.execute("value"));
+            REQUIRE_THROWS(interpreter.execute("each 3 1"));
+        }
+
+        SECTION("Iterations do not allocate")
+        {
+            for (const char *loop : {"times_loop", "each range 0"})
+            {
+                auto allocations = [&](const char *count)
+                {
+                    std::string program = std::string(loop) + " " + count + " if less index 0 stop plus index value";
+                    std::size_t before = allocationCount;
+                    interpreter.execute(program);
+                    return allocationCount - before;
+                };
+                allocations("10"); // Grows the operand stack and loop stacks
+                INFO(loop);
+                REQUIRE(allocations("20000") == allocations("10"));
+            }
+        }
+    }
+}
+
+TEST_CASE("Input source", "[interpreter][input]")
+{
+    SECTION("Lines are split on \\n and \\r\\n")
+    {
+        StringSource source("one\ntwo\r\n\nlast");
+        std::string_view line;
+        REQUIRE(source.readLine(line));
+        REQUIRE(line == "one");
+        REQUIRE(source.readLine(line));
+        REQUIRE(line == "two");
+        REQUIRE(source.readLine(line));
+        REQUIRE(line.empty());
+        REQUIRE(source.readLine(line));
+        REQUIRE(line == "last");
+        REQUIRE_FALSE(source.readLine(line));
+        REQUIRE_FALSE(source.readLine(line));
+    }
+
+    SECTION("Lines longer than the buffer grow it")
+    {
+        std::string longLine(100, 'x');
+        StringSource source("ab\n" + longLine + "\ncd\n", 8);
+        std::string_view line;
+        REQUIRE(source.readLine(line));
+        REQUIRE(line == "ab");
+        REQUIRE(source.readLine(line));
+        REQUIRE(line == longLine);
+        REQUIRE(source.readLine(line));
+        REQUIRE(line == "cd");
+        REQUIRE_FALSE(source.readLine(line));
+    }
+
+    Interpreter interpreter;
+    auto output = std::make_unique<StringSink>();
+    StringSink &text = *output;
+    interpreter.setOutput(std::move(output));
+
+    SECTION("input returns null at the end of the input")
+    {
+        interpreter.setInput(std::make_unique<StringSource>("first\n\n"));
+        REQUIRE(interpreter.execute("input").asString() == "first");
+        REQUIRE(interpreter.execute("input").asString().empty());
+        REQUIRE(interpreter.execute("input").isNull());
+    }
+
+    SECTION("lines is a lazy sequence ending with the input")
+    {
+        interpreter.setInput(std::make_unique<StringSource>("3\n1\n4\n"));
+        REQUIRE(interpreter.execute("type lines").asString() == "sequence");
+        REQUIRE(interpreter.execute("sum map lines \"number\" 0").asNumber() == 8.0);
+
+        interpreter.setInput(std::make_unique<StringSource>("a\nbb\nccc"));
+        interpreter.execute("each lines println plus key value");
+        REQUIRE(text.str() == "0a\n1bb\n2ccc\n");
+    }
+
+    SECTION("Kept lines keep their text")
+    {
+        interpreter.setInput(std::make_unique<StringSource>("x\ny\nz\n"));
+        REQUIRE(interpreter.execute("each lines set object \"last\" value").toString() == "{\"last\": z}");
+
+        interpreter.setInput(std::make_unique<StringSource>("first\nsecond\n"));
+        REQUIRE(interpreter.execute("each zip lines lines value").toString() == "[first, second]");
+    }
+
+    SECTION("Memory use does not grow with the input")
+    {
+        auto allocations = [&](int count)
+        {
+            std::string input;
+            for (int i = 0; i < count; ++i)
+            {
+                input += "line " + std::to_string(i) + "\n";
+            }
+            interpreter.setInput(std::make_unique<StringSource>(std::move(input)));
+            std::size_t before = allocationCount;
+            interpreter.execute("each lines length value");
+            return allocationCount - before;
+        };
+        allocations(10);
+        REQUIRE(allocations(20000) == allocations(10));
+    }
+}
+
+TEST_CASE("Files", "[interpreter][files]")
+{
+    namespace fs = std::filesystem;
+    const fs::path directory = fs::temp_directory_path();
+    auto writeFile = [&](const char *name, const std::string &contents)
+    {
+        fs::path path = directory / name;
+        std::ofstream(path, std::ios::binary) << contents;
+        return path.string();
+    };
+
+    SECTION("Regular files are mapped, others read")
+    {
+        std::string path = writeFile("pangea_mapped.txt", "mapped\ntext");
+        MappedFile file(path);
+        REQUIRE(file.isMapped());
+        REQUIRE(file.text() == "mapped\ntext");
+        file.release(file.text().size());
+        REQUIRE(file.text() == "mapped\ntext");
+
+        MappedFile moved(std::move(file));
+        REQUIRE(moved.text() == "mapped\ntext");
+
+        MappedFile empty(writeFile("pangea_empty.txt", ""));
+        REQUIRE_FALSE(empty.isMapped());
+        REQUIRE(empty.text().empty());
+
+        MappedFile device("/dev/null");
+        REQUIRE_FALSE(device.isMapped());
+        REQUIRE(device.text().empty());
+
+        REQUIRE_THROWS(MappedFile((directory / "pangea_missing.txt").string()));
+        fs::remove(path);
+    }
+
+    SECTION("Scripts run from their mapped pages")
+    {
+        std::string path = writeFile("pangea_script.pg", "# comment\nplus times 6 7 \"!\"\n");
+        Interpreter interpreter;
+        REQUIRE(interpreter.execute(MappedFile(path)).asString() == "42!");
+        fs::remove(path);
+    }
+
+    SECTION("read_file, file_size and file_lines")
+    {
+        std::string path = writeFile("pangea_data.txt", "10\r\n20\n30\n");
+        Interpreter interpreter;
+        std::string quoted = "\"" + path + "\"";
+        REQUIRE(interpreter.execute("read_file " + quoted).asString() == "10\r\n20\n30\n");
+        REQUIRE(interpreter.execute("file_size " + quoted).asInteger() == 10);
+        REQUIRE(interpreter.execute("sum map file_lines " + quoted + " \"number\" 0").asNumber() == 60.0);
+
+        // Every pass reads the file from the top
+        interpreter.execute("set object \"lines\" file_lines " + quoted);
+        REQUIRE(interpreter.execute("length file_lines " + quoted).asInteger() == 3);
+        REQUIRE(interpreter.execute("each file_lines " + quoted + " value").asString() == "30");
+
+        REQUIRE(interpreter.execute("length file_lines \"/dev/null\"").asInteger() == 0);
+        REQUIRE_THROWS(interpreter.execute("read_file \"" + (directory / "pangea_missing.txt").string() + "\""));
+        REQUIRE_THROWS(interpreter.execute("length file_lines \"" + (directory / "pangea_missing.txt").string() + "\""));
+        REQUIRE_THROWS(interpreter.execute("file_size \"/dev/null\""));
+        fs::remove(path);
+    }
+
+    SECTION("Lines stay intact across released pages")
+    {
+        // Large enough to pass several release intervals
+        std::string contents;
+        for (int i = 0; i < 1000000; ++i)
+        {
+            contents += std::to_string(i) + "\n";
+        }
+        std::string path = writeFile("pangea_large.txt", contents);
+
+        auto source = InputSource::open(path);
+        std::string_view line;
+        std::int64_t count = 0;
+        std::int64_t mismatches = 0;
+        while (source->readLine(line))
+        {
+            mismatches += line != std::to_string(count);
+            ++count;
+        }
+        REQUIRE(count == 1000000);
+        REQUIRE(mismatches == 0);
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("CSV reading", "[builtins][csv]")
+{
+    SECTION("Columns are packed by type")
+    {
+        Value table = CsvReader::parse("id,price,name\n1,2.5,apple\n2,,\"banana, ripe\"\r\n3,-4,\"say \"\"hi\"\"\nthere\"\n");
+        const Object &columns = table.asObject();
+        REQUIRE(columns.size() == 3);
+        REQUIRE(columns.keyAt(0) == "id");
+        REQUIRE(columns.keyAt(2) == "name");
+
+        const Value &id = *columns.find("id");
+        REQUIRE(id.isNumberArray());
+        REQUIRE(id.asNumberArray() == std::vector<double>{1, 2, 3});
+
+        const auto &price = columns.find("price")->asNumberArray();
+        REQUIRE(price.size() == 3);
+        REQUIRE(price[0] == 2.5);
+        REQUIRE(std::isnan(price[1]));
+        REQUIRE(price[2] == -4.0);
+
+        const Value &name = *columns.find("name");
+        REQUIRE(name.isStringArray());
+        REQUIRE(name.arraySize() == 3);
+        REQUIRE(name.asStringArray().at(1) == "banana, ripe");
+        REQUIRE(name.arrayAt(2).asString() == "say \"hi\"\nthere");
+    }
+
+    SECTION("A column with any non-number keeps its original text")
+    {
+        Value table = CsvReader::parse("code,n\n007,1\n2.50,2\nx1,3\n");
+        const Value &code = *table.asObject().find("code");
+        REQUIRE(code.isStringArray());
+        REQUIRE(code.toString() == "[007, 2.50, x1]");
+        REQUIRE(table.asObject().find("n")->isNumberArray());
+    }
+
+    SECTION("Several columns turning into text late keep every field")
+    {
+        // Quoted, signed and exponent numbers, empty fields, CRLF and a
+        // short record all precede the last row, which has text everywhere
+        for (char delimiter : {',', ';'})
+        {
+            std::string d(1, delimiter);
+            std::string text = "a" + d + "b" + d + "c" + d + "d\n";
+            for (int i = 0; i < 3000; ++i)
+            {
+                text += std::to_string(i) + d + "\"" + std::to_string(-i) + "\"" + d + d + "1e" + std::to_string(i % 5) + (i % 2 ? "\r\n" : "\n");
+            }
+            text += "7" + d + "8\n";
+            text += "w" + d + "x" + d + "y" + d + "z\n";
+            Value table = CsvReader::parse(text, delimiter);
+            const Object &columns = table.asObject();
+            for (std::uint32_t slot = 0; slot < 4; ++slot)
+            {
+                REQUIRE(columns.valueAt(slot).isStringArray());
+                REQUIRE(columns.valueAt(slot).arraySize() == 3002);
+            }
+            const StringColumn &a = columns.find("a")->asStringArray();
+            const StringColumn &b = columns.find("b")->asStringArray();
+            const StringColumn &c = columns.find("c")->asStringArray();
+            const StringColumn &e = columns.find("d")->asStringArray();
+            REQUIRE(a.at(2999) == "2999");
+            REQUIRE(b.at(17) == "-17");
+            REQUIRE(c.at(5).empty());
+            REQUIRE(e.at(3) == "1e3");
+            REQUIRE(e.at(2998) == "1e3");
+            REQUIRE(a.at(3000) == "7");
+            REQUIRE(b.at(3000) == "8");
+            REQUIRE(e.at(3000).empty());
+            REQUIRE(a.at(3001) == "w");
+            REQUIRE(e.at(3001) == "z");
+        }
+    }
+
+    SECTION("Record shapes")
+    {
+        // Blank lines are skipped and short records padded
+        Value table = CsvReader::parse("a,b,c\n\n1,x\n\r\n2,y,3\n4");
+        const Object &columns = table.asObject();
+        REQUIRE(columns.find("a")->asNumberArray() == std::vector<double>{1, 2, 4});
+        REQUIRE(columns.find("b")->toString() == "[x, y, ]");
+        REQUIRE(std::isnan(columns.find("c")->asNumberArray()[0]));
+
+        REQUIRE(CsvReader::parse("").asObject().empty());
+        REQUIRE(CsvReader::parse("a,b\n").asObject().find("b")->arraySize() == 0);
+        REQUIRE(CsvReader::parse("a\tb\n1\t\"2\"\n", '\t').asObject().find("b")->asNumberArray() == std::vector<double>{2});
+
+        auto error = [](std::string_view text)
+        {
+            try
+            {
+                CsvReader::parse(text);
+            }
+            catch (const std::runtime_error &e)
+            {
+                return std::string(e.what());
+            }
+            return std::string();
+        };
+        REQUIRE(error("a,b\n1,2\n1,2,3\n") == "More fields than the header has columns in CSV record 3");
+        REQUIRE(error("a\n\"open\n") == "Unterminated quoted field in CSV record 2");
+        REQUIRE(error("a\n\"x\"y\n") == "Unexpected text after a quoted field in CSV record 2");
+        REQUIRE_THROWS(CsvReader::parse("a,a\n1,2\n"));
+    }
+
+    SECTION("Columns sized from a sample keep growing correctly")
+    {
+        // Past the sample the columns are reserved; "x" turns a column
+        // into strings long after that
+        std::string text = "n,label,late\n";
+        for (int i = 0; i < 5000; ++i)
+        {
+            text += std::to_string(i) + ",\"row " + std::to_string(i) + "\"," + (i == 4000 ? "x" : std::to_string(i % 7)) + "\n";
+        }
+        Value table = CsvReader::parse(text);
+        const Object &columns = table.asObject();
+        const auto &n = columns.find("n")->asNumberArray();
+        REQUIRE(n.size() == 5000);
+        REQUIRE(n[4999] == 4999.0);
+        REQUIRE(columns.find("label")->asStringArray().at(4321) == "row 4321");
+        const auto &late = columns.find("late")->asStringArray();
+        REQUIRE(late.size() == 5000);
+        REQUIRE(late.at(3999) == "2");
+        REQUIRE(late.at(4000) == "x");
+        REQUIRE(late.at(4999) == "1");
+    }
+
+    SECTION("Scanner backends find the same field stops")
+    {
+        std::string text;
+        for (int i = 0; i < 200; ++i)
+        {
+            text += std::string(i % 37, 'v') + (i % 5 == 0 ? "\"" : i % 3 == 0 ? "\n" : i % 2 == 0 ? "\t" : ",");
+        }
+        text.resize(text.size() - text.size() % Scanner::FieldBlockSize);
+
+        const Scanner::Backend original = Scanner::getBackend();
+        for (auto backend : {Scanner::Backend::Scalar, Scanner::Backend::SSE2, Scanner::Backend::AVX2})
+        {
+            if (!Scanner::isSupported(backend))
+            {
+                continue;
+            }
+            INFO(Scanner::getBackendName(backend));
+            Scanner::setBackend(backend);
+            std::size_t mismatches = 0;
+            for (std::size_t block = 0; block < text.size(); block += Scanner::FieldBlockSize)
+            {
+                std::uint64_t expected = 0;
+                for (std::size_t i = 0; i < Scanner::FieldBlockSize; ++i)
+                {
+                    char c = text[block + i];
+                    expected |= static_cast<std::uint64_t>(c == ',' || c == '"' || c == '\n') << i;
+                }
+                mismatches += Scanner::fieldStops(text.data() + block, ',') != expected;
+            }
+            REQUIRE(mismatches == 0);
+
+            // Fields spanning blocks and a partial last block parse alike
+            Value table = CsvReader::parse("a,b\n" + std::string(100, 'x') + "," + std::string(70, 'y') + "\n1,2");
+            REQUIRE(table.asObject().find("a")->asStringArray().at(0).size() == 100);
+            REQUIRE(table.asObject().find("b")->asStringArray().at(1) == "2");
+        }
+        Scanner::setBackend(original);
+    }
+
+    SECTION("String columns behave as arrays")
+    {
+        StringColumn strings;
+        strings.push_back("a");
+        strings.push_back("");
+        strings.push_back("ccc");
+        Value column(std::move(strings));
+        REQUIRE(column.getType() == Value::Type::Array);
+        REQUIRE(column == Value(std::vector<Value>{Value("a"), Value(""), Value("ccc")}));
+        REQUIRE(column.asArray()[2].asString() == "ccc");
+
+        Value copy = column;
+        copy.asArrayMutable().push_back(Value(1.0));
+        REQUIRE_FALSE(copy.isStringArray());
+        REQUIRE(copy.arraySize() == 4);
+        REQUIRE(column.isStringArray());
+        REQUIRE(column.arraySize() == 3);
+    }
+
+    SECTION("read_csv and read_tsv")
+    {
+        namespace fs = std::filesystem;
+        fs::path path = fs::temp_directory_path() / "pangea_table.csv";
+        std::ofstream(path, std::ios::binary) << "item,qty,price\nbolt,10,0.25\nnut,20,0.1\n\"washer, m8\",5,0.05\n";
+        std::string quoted = "\"" + path.string() + "\"";
+
+        Interpreter interpreter;
+        interpreter.execute("set object \"unused\" 0");
+        REQUIRE(interpreter.execute("length read_csv " + quoted).asInteger() == 3);
+        REQUIRE(interpreter.execute("sum get read_csv " + quoted + " \"qty\"").asNumber() == 35.0);
+        REQUIRE(std::abs(interpreter.execute("dot get read_csv " + quoted + " \"qty\" get read_csv " + quoted + " \"price\"").asNumber() - 4.75) < 1e-12);
+        REQUIRE(interpreter.execute("get get read_csv " + quoted + " \"item\" 2").asString() == "washer, m8");
+        REQUIRE(interpreter.execute("join get read_csv " + quoted + " \"item\" \"|\"").asString() == "bolt|nut|washer, m8");
+        REQUIRE(interpreter.execute("count_if map get read_csv " + quoted + " \"item\" \"equal\" \"nut\"").asInteger() == 1);
+        REQUIRE_THROWS(interpreter.execute("sum get read_csv " + quoted + " \"item\""));
+
+        std::ofstream(path, std::ios::binary) << "a\tb\n1\tx y\n";
+        REQUIRE(interpreter.execute("get get read_tsv " + quoted + " \"b\" 0").asString() == "x y");
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("Tables", "[builtins][table]")
+{
+    // 3000 rows, enough for filters over a selection to span blocks
+    std::string text = "n,group,label\n";
+    for (int i = 0; i < 3000; ++i)
+    {
+        text += std::to_string(i % 37) + "," + std::to_string(i % 5) + "," + (i % 3 == 0 ? "x" : i % 3 == 1 ? "y" : "z") + "\n";
+    }
+    const Table table = Table::fromColumns(CsvReader::parse(text).asObject());
+
+    auto conditions = [](std::string_view column, Value operand)
+    {
+        Object object;
+        object.set(column, std::move(operand));
+        return object;
+    };
+
+    SECTION("Columns are shared and rows selected")
+    {
+        REQUIRE(table.rowCount() == 3000);
+        REQUIRE(table.columnCount() == 3);
+        REQUIRE(table.findColumn("label") == 2);
+        REQUIRE(table.findColumn("missing") == Table::NotFound);
+        REQUIRE(table.column(0).isNumberArray());
+        REQUIRE(table.column(2).isStringArray());
+        REQUIRE(table.row(4).toString() == "{\"n\": 4, \"group\": 4, \"label\": y}");
+
+        bool threw = false;
+        try
+        {
+            Object uneven;
+            uneven.set("a", Value(std::vector<double>{1, 2}));
+            uneven.set("b", Value(std::vector<double>{1}));
+            Table::fromColumns(uneven);
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        REQUIRE(threw);
+    }
+
+    SECTION("Kernel filters match calling the function per row")
+    {
+        // The same comparisons through the fallback, which calls a function
+        const std::pair<VectorMath::Op, const char *> comparisons[] = {
+            {VectorMath::Op::Less, "less"}, {VectorMath::Op::Greater, "greater"}, {VectorMath::Op::Equal, "equal"}};
+        for (auto [op, name] : comparisons)
+        {
+            FunctionEntry function(name, 2, [op](const std::vector<Value> &args)
+                                   {
+                std::string a = args[0].toString(), b = args[1].toString();
+                bool result = args[0].isNumber() ? (op == VectorMath::Op::Less ? args[0].asNumber() < args[1].asNumber() : op == VectorMath::Op::Greater ? args[0].asNumber() > args[1].asNumber() : args[0].asNumber() == args[1].asNumber())
+                                                 : (op == VectorMath::Op::Less ? a < b : op == VectorMath::Op::Greater ? a > b : a == b);
+                return Value(result); });
+
+            // A first condition over every row, then one over a selection
+            Object both = conditions("n", Value(20.0));
+            both.set("label", Value("y"));
+            for (const Object &condition : {conditions("n", Value(20.0)), conditions("label", Value("y")), both})
+            {
+                Table kernels = table.filter(condition, function, op);
+                Table called = table.filter(condition, function, std::nullopt);
+                REQUIRE(kernels.rowCount() == called.rowCount());
+                REQUIRE(kernels == called);
+            }
+        }
+
+        FunctionEntry unused("less", 2, [](const std::vector<Value> &)
+                             { return Value(); });
+        Table narrowed = table.filter(conditions("n", Value(3.0)), unused, VectorMath::Op::Less);
+        REQUIRE(narrowed.rowCount() == 3000 / 37 * 3 + 3);
+        narrowed = narrowed.filter(conditions("group", Value(0.0)), unused, VectorMath::Op::Equal);
+        for (std::size_t i = 0; i < narrowed.rowCount(); ++i)
+        {
+            Value row = narrowed.row(i);
+            REQUIRE(row.asObject().find("n")->asNumber() < 3.0);
+            REQUIRE(row.asObject().find("group")->asNumber() == 0.0);
+        }
+    }
+
+    SECTION("Grouped aggregates match a direct computation")
+    {
+        Object spec;
+        spec.set("n", Value("sum"));
+        spec.set("label", Value("count"));
+        Table summary = table.groupBy("group").aggregate(spec);
+        REQUIRE(summary.rowCount() == 5);
+        REQUIRE(summary.nameAt(0) == "group");
+        REQUIRE(summary.column(0).asNumberArray() == std::vector<double>{0, 1, 2, 3, 4});
+
+        std::vector<double> sums(5, 0.0);
+        for (int i = 0; i < 3000; ++i)
+        {
+            sums[i % 5] += i % 37;
+        }
+        REQUIRE(summary.column(1).asNumberArray() == sums);
+        REQUIRE(summary.column(2).asNumberArray() == std::vector<double>(5, 600.0));
+
+        // String keys, in order of first appearance, over a selection
+        FunctionEntry unused("greater", 2, [](const std::vector<Value> &)
+                             { return Value(); });
+        Object extremes;
+        extremes.set("n", Value("max"));
+        extremes.set("group", Value("min"));
+        Table byLabel = table.filter(conditions("n", Value(30.0)), unused, VectorMath::Op::Less).groupBy("label").aggregate(extremes);
+        REQUIRE(byLabel.column(0).toString() == "[x, y, z]");
+        REQUIRE(byLabel.column(1).asNumberArray() == std::vector<double>{29, 29, 29});
+        REQUIRE(byLabel.column(2).asNumberArray() == std::vector<double>{0, 0, 0});
+
+        Object mean;
+        mean.set("n", Value("mean"));
+        Table overall = table.aggregate(mean);
+        REQUIRE(overall.rowCount() == 1);
+        REQUIRE(std::abs(overall.column(0).asNumberArray()[0] - (sums[0] + sums[1] + sums[2] + sums[3] + sums[4]) / 3000.0) < 1e-12);
+    }
+
+    SECTION("Number keys group alike by index and by hash")
+    {
+        // Whole numbers in a narrow range are indexed, others hashed. -0
+        // groups with 0 on both paths, and NaNs (always hashed) together
+        const double nan = std::nan("");
+        for (double scale : {1.0, 1e12, 0.5})
+        {
+            for (double other : {scale, nan})
+            {
+                Object columns;
+                columns.set("key", Value(std::vector<double>{3 * scale, 0.0, -0.0, other, 3 * scale, -2 * scale, other}));
+                columns.set("v", Value(std::vector<double>{1, 2, 3, 4, 5, 6, 7}));
+                Object spec;
+                spec.set("v", Value("sum"));
+                Table summary = Table::fromColumns(columns).groupBy("key").aggregate(spec);
+                REQUIRE(summary.rowCount() == 4);
+                REQUIRE(summary.column(1).asNumberArray() == std::vector<double>{6, 5, 11, 6});
+            }
+        }
+    }
+
+    SECTION("Table builtins")
+    {
+        Interpreter interpreter;
+        REQUIRE(interpreter.execute("type table object").asString() == "table");
+
+        // Columns built as arrays in a script
+        std::string program = "table set set object \"item\" set set set set array 0 \"bolt\" 1 \"nut\" 2 \"bolt\" 3 \"washer\" "
+                              "\"qty\" set set set set array 0 4 1 10 2 6 3 1";
+        REQUIRE(interpreter.execute("length " + program).asInteger() == 4);
+        REQUIRE(interpreter.execute("get " + program + " \"qty\"").toString() == "[4, 10, 6, 1]");
+        REQUIRE(interpreter.execute("get get " + program + " 2 \"item\"").asString() == "bolt");
+        REQUIRE(interpreter.execute("get filter " + program + " \"greater\" set object \"qty\" 5 \"item\"").toString() == "[nut, bolt]");
+        REQUIRE(interpreter.execute("aggregate group_by " + program + " \"item\" set object \"qty\" \"sum\"").toString() ==
+                "{\"item\": [bolt, nut, washer], \"qty\": [10, 10, 1]}");
+        REQUIRE(interpreter.execute("select " + program + " \"qty\"").toString() == "{\"qty\": [4, 10, 6, 1]}");
+
+        // Other functions are called per row
+        REQUIRE(interpreter.execute("length filter " + program + " \"plus\" set object \"qty\" -4").asInteger() == 3);
+        REQUIRE_THROWS(interpreter.execute("filter " + program + " \"less\" 3"));
+
+        // Functions are checked as for sequences before any row is read
+        for (const char *function : {"set", "if", "and", "array"})
+        {
+            bool rejected = false;
+            try
+            {
+                interpreter.execute("filter " + program + " \"" + function + "\" set object \"qty\" 1");
+            }
+            catch (const std::runtime_error &error)
+            {
+                rejected = std::string(error.what()) == "filter expects a function of one or two arguments";
+            }
+            REQUIRE(rejected);
+        }
+        REQUIRE_THROWS(interpreter.execute("select " + program + " \"price\""));
+        REQUIRE_THROWS(interpreter.execute("aggregate " + program + " set object \"qty\" \"median\""));
+        REQUIRE_THROWS(interpreter.execute("aggregate " + program + " set object \"item\" \"sum\""));
+    }
+}
+
+TEST_CASE("Symbol interning", "[interpreter][symbols]")
+{
+    Interpreter interpreter;
+
+    SECTION("Builtins are bound by symbol")
+    {
+        const FunctionEntry *plus = interpreter.findFunction("plus");
+        REQUIRE(plus != nullptr);
+        REQUIRE(plus->getArity() == 2);
+        REQUIRE(interpreter.findFunction("no_such_function") == nullptr);
+        REQUIRE(interpreter.getSymbols().getName(interpreter.getSymbols().find("plus")) == "plus");
+    }
+
+    SECTION("Identifiers are interned once, literals are not")
+    {
+        size_t before = interpreter.getSymbols().size();
+        interpreter.execute("plus foo plus foo bar \"quoted\" 42 -1.5");
+        const auto &symbols = interpreter.getSymbols();
+        REQUIRE(symbols.size() == before + 2);
+        REQUIRE(symbols.find("foo") != SymbolTable::None);
+        REQUIRE(symbols.find("\"quoted\"") == SymbolTable::None);
+        REQUIRE(symbols.find("42") == SymbolTable::None);
+    }
+
+    SECTION("Unbound identifiers still evaluate to strings")
+    {
+        Value result = interpreter.execute("plus hello world");
+        REQUIRE(result.toString() == "helloworld");
+    }
+}
+
+TEST_CASE("Phrase length analysis", "[interpreter][phrases]")
+{
+    Interpreter interpreter;
+
+    SECTION("Nested phrases")
+    {
+        interpreter.execute("plus times 2 3 4 not true");
+        REQUIRE(interpreter.getPhraseLengths() == std::vector<int>{5, 3, 1, 1, 1, 2, 1});
+    }
+
+    SECTION("Deeply nested phrases")
+    {
+        const int depth = 2000;
+        std::string code;
+        for (int i = 0; i < depth; ++i)
+        {
+            code += "plus ";
+        }
+        for (int i = 0; i <= depth; ++i)
+        {
+            code += "1 ";
+        }
+        Value result = interpreter.execute(code);
+        REQUIRE(result.asNumber() == depth + 1.0);
+        REQUIRE(interpreter.getPhraseLengths()[0] == 2 * depth + 1);
+        REQUIRE(interpreter.getPhraseLengths()[depth - 1] == 3);
+    }
+
+    SECTION("Appended chunks complete pending phrases")
+    {
+        Value result = interpreter.executeChunk("plus 1");
+        REQUIRE(result.isNull());
+        REQUIRE(interpreter.hasPendingPhrase());
+
+        result = interpreter.executeChunk("times 2");
+        REQUIRE(result.isNull());
+        REQUIRE(interpreter.hasPendingPhrase());
+
+        result = interpreter.executeChunk("3 minus 10 4");
+        REQUIRE_FALSE(interpreter.hasPendingPhrase());
+        REQUIRE(result.asNumber() == 6.0);
+        REQUIRE(interpreter.getPhraseLengths() == std::vector<int>{5, 1, 3, 1, 1, 3, 1, 1});
+
+        interpreter.setExecutionMode(Interpreter::ExecutionMode::TreeWalk);
+        result = interpreter.executeChunk("plus \"a\" \"b\"");
+        REQUIRE(result.asString() == "ab");
+    }
+}
+
+TEST_CASE("Deep nesting is evaluated without recursion", "[interpreter][depth]")
+{
+    auto nestedPlus = [](int depth)
+    {
+        std::string code;
+        for (int i = 0; i < depth; ++i)
+        {
+            code += "plus ";
+        }
+        for (int i = 0; i <= depth; ++i)
+        {
+            code += "1 ";
+        }
+        return code;
+    };
+
+    for (auto mode : {Interpreter::ExecutionMode::Bytecode, Interpreter::ExecutionMode::TreeWalk})
+    {
+        Interpreter interpreter;
+        interpreter.setExecutionMode(mode);
+
+        interpreter.setMaxDepth(500000);
+        REQUIRE(interpreter.execute(nestedPlus(200000)).asNumber() == 200001.0);
+
+        interpreter.setMaxDepth(1000);
+        REQUIRE_THROWS_AS(interpreter.execute(nestedPlus(1001)), std::runtime_error);
+
+        // The interpreter stays usable after the error
+        REQUIRE(interpreter.execute(nestedPlus(1000)).asNumber() == 1001.0);
+    }
+}
+
+TEST_CASE("Deep special form nesting fails cleanly", "[interpreter][depth]")
+{
+    // Special forms evaluate their phrases on the C++ stack, so their
+    // nesting has a lower limit of its own
+    auto chain = [](const char *form, int depth, const char *last)
+    {
+        std::string code;
+        for (int i = 0; i < depth; ++i)
+        {
+            code += form;
+        }
+        return code + last;
+    };
+    const int limit = static_cast<int>(Interpreter::MaxSpecialFormDepth);
+
+    for (auto mode : {Interpreter::ExecutionMode::Bytecode, Interpreter::ExecutionMode::TreeWalk})
+    {
+        Interpreter interpreter;
+        interpreter.setExecutionMode(mode);
+
+        REQUIRE(interpreter.execute(chain("if false 0 ", limit, "1")).asNumber() == 1.0);
+        REQUIRE(interpreter.execute(chain("and true ", limit, "true")).asBoolean());
+        REQUIRE(interpreter.execute(chain("or false ", limit, "true")).asBoolean());
+
+        REQUIRE_THROWS_AS(interpreter.execute(chain("if false 0 ", limit + 1, "1")), std::runtime_error);
+        REQUIRE_THROWS_AS(interpreter.execute(chain("if false 0 ", 20000, "1")), std::runtime_error);
+        REQUIRE_THROWS_AS(interpreter.execute(chain("and true ", 200000, "true")), std::runtime_error);
+        REQUIRE_THROWS_AS(interpreter.execute(chain("or false ", 200000, "true")), std::runtime_error);
+
+        // A lower max depth applies to special forms too
+        interpreter.setMaxDepth(100);
+        REQUIRE_THROWS_AS(interpreter.execute(chain("and true ", 101, "true")), std::runtime_error);
+        REQUIRE(interpreter.execute(chain("and true ", 100, "true")).asBoolean());
+        interpreter.setMaxDepth(Interpreter::DefaultMaxDepth);
+
+        // The interpreter stays usable after the error
+        REQUIRE(interpreter.execute(chain("if false 0 ", 10, "7")).asNumber() == 7.0);
+    }
+}
+
+TEST_CASE("Builtin calling convention", "[function]")
+{
+    SECTION("Member builtins take the fast path without allocating")
+    {
+        Interpreter interpreter;
+        for (const char *name : {"plus", "less", "get", "equal"})
+        {
+            const FunctionEntry *entry = interpreter.findFunction(name);
+            REQUIRE(entry->hasFastPath());
+
+            std::vector<Value> args = {Value(2.0), Value(3.0)};
+            std::size_t before = allocationCount;
+            Value result = entry->invoke(ValueSpan(args.data(), entry->getArity()));
+            REQUIRE(allocationCount == before);
+        }
+        REQUIRE(interpreter.findFunction("plus")->getArity() == 2);
+        REQUIRE(interpreter.findFunction("if")->getArity() == 3);
+        REQUIRE(interpreter.findFunction("input")->getArity() == 0);
+    }
+
+    SECTION("std::function builtins still work")
+    {
+        FunctionEntry entry("join", 2, [](const std::vector<Value> &args)
+                            { return Value(args[0].toString() + args[1].toString()); });
+        REQUIRE_FALSE(entry.hasFastPath());
+        std::vector<Value> args = {Value(1.0), Value(2.0)};
+        REQUIRE(entry.invoke(args).asString() == "12");
+    }
+}
+
+TEST_CASE("String concatenation", "[value][builtins]")
+{
+    SECTION("Long concatenations are ropes flattened on demand")
+    {
+        const std::string piece(40, 'x');
+        Value text("");
+        for (int i = 0; i < 100000; ++i)
+        {
+            text = Value::concat(text, Value(piece));
+        }
+        REQUIRE(text.stringLength() == piece.size() * 100000);
+        REQUIRE(text.isTruthy());
+
+        const std::string &flat = text.asString();
+        REQUIRE(flat.size() == piece.size() * 100000);
+        REQUIRE(flat.find_first_not_of('x') == std::string::npos);
+    }
+
+    SECTION("Rope pieces keep their own values")
+    {
+        Value left(std::string(50, 'a'));
+        Value right(std::string(50, 'b'));
+        Value joined = Value::concat(left, right);
+        REQUIRE(joined == Value(std::string(50, 'a') + std::string(50, 'b')));
+        REQUIRE(left.asString() == std::string(50, 'a'));
+        REQUIRE(Value::concat(Value("ab"), Value("cd")).asString() == "abcd");
+        REQUIRE_THROWS(Value::concat(Value("a"), Value(1.0)));
+    }
+
+    SECTION("plus and join")
+    {
+        Interpreter interpreter;
+        REQUIRE(interpreter.execute("plus \"a\" 1").asString() == "a1");
+        REQUIRE(interpreter.execute("length plus \"hello \" \"world\"").asNumber() == 11.0);
+        REQUIRE(interpreter.execute("join set set set array 0 \"a\" 1 2 2 true \", \"").asString() == "a, 2, true");
+        REQUIRE(interpreter.execute("join array \"-\"").asString() == "");
+    }
+}
+
+TEST_CASE("Flat hash map", "[object]")
+{
+    SECTION("Insert, find and grow")
+    {
+        FlatMap<int> map;
+        REQUIRE(map.find("missing") == FlatMap<int>::NotFound);
+        bool allAdded = true;
+        for (int i = 0; i < 100000; ++i)
+        {
+            auto [index, added] = map.insert("key" + std::to_string(i), i);
+            allAdded = allAdded && added && index == static_cast<std::uint32_t>(i);
+        }
+        REQUIRE(allAdded);
+        REQUIRE(map.size() == 100000);
+
+        bool allFound = true;
+        for (int i = 0; i < 100000; ++i)
+        {
+            std::uint32_t index = map.find("key" + std::to_string(i));
+            allFound = allFound && index != FlatMap<int>::NotFound && map.valueAt(index) == i;
+        }
+        REQUIRE(allFound);
+        REQUIRE(map.find("key100000") == FlatMap<int>::NotFound);
+
+        auto [index, added] = map.insert("key42", -1);
+        REQUIRE_FALSE(added);
+        REQUIRE(map.valueAt(index) == 42);
+    }
+
+    SECTION("Iteration follows insertion order")
+    {
+        FlatMap<int> map;
+        map.reserve(3);
+        map.insert("c", 1);
+        map.insert("a", 2);
+        map.insert("b", 3);
+
+        std::string keys;
+        for (const auto &entry : map)
+        {
+            keys += entry.key;
+        }
+        REQUIRE(keys == "cab");
+    }
+}
+
+TEST_CASE("Object shapes", "[object]")
+{
+    SECTION("Objects built alike share a shape")
+    {
+        Object first;
+        Object second;
+        first.set("x", Value(1.0));
+        first.set("y", Value(2.0));
+        second.set("x", Value(3.0));
+        second.set("y", Value(4.0));
+        REQUIRE(first.getShape() == second.getShape());
+        REQUIRE(first.findSlot("y") == 1);
+
+        Object other;
+        other.set("y", Value(1.0));
+        other.set("x", Value(2.0));
+        REQUIRE(other.getShape() != first.getShape());
+        REQUIRE_FALSE(other == first);
+
+        Object reordered;
+        reordered.set("y", Value(2.0));
+        reordered.set("x", Value(1.0));
+        REQUIRE(reordered == first);
+    }
+
+    SECTION("Keys keep insertion order")
+    {
+        Object object;
+        object.set("zeta", Value(1.0));
+        object.set("alpha", Value(2.0));
+        object.set("zeta", Value(3.0));
+        REQUIRE(Value(object).toString() == "{\"zeta\": 3, \"alpha\": 2}");
+    }
+
+    SECTION("Large objects switch to dictionary mode")
+    {
+        Object object;
+        for (int i = 0; i < 1000; ++i)
+        {
+            object.set("key" + std::to_string(i), Value(static_cast<double>(i)));
+        }
+        REQUIRE(object.getShape() == nullptr);
+        REQUIRE(object.size() == 1000);
+        REQUIRE(object.keyAt(0) == "key0");
+        REQUIRE(object.keyAt(999) == "key999");
+        REQUIRE(object.find("key500")->asNumber() == 500.0);
+        REQUIRE(object.find("missing") == nullptr);
+    }
+
+    SECTION("Unused shapes are freed")
+    {
+        const std::size_t before = Shape::empty()->transitionCount();
+        for (int i = 0; i < 10000; ++i)
+        {
+            Object object;
+            object.set("unique" + std::to_string(i), Value(1.0));
+            object.set("next", Value(2.0));
+        }
+        REQUIRE(Shape::empty()->transitionCount() == before);
+
+        // A live shape keeps its path, and a path shares its key storage
+        Object deep;
+        for (int i = 0; i < 40; ++i)
+        {
+            deep.set("deep" + std::to_string(i), Value(static_cast<double>(i)));
+        }
+        auto first = Shape::empty()->withKey("deep0");
+        REQUIRE(Shape::empty()->transitionCount() == before + 1);
+        REQUIRE(first->withKey("deep1")->size() == 2);
+        REQUIRE(&first->keyAt(0) == &deep.keyAt(0));
+        REQUIRE(deep.keyAt(39) == "deep39");
+
+        // A sibling path copies the shared prefix
+        auto sibling = first->withKey("other");
+        REQUIRE(sibling->size() == 2);
+        REQUIRE(sibling->keyAt(0) == "deep0");
+        REQUIRE(sibling->keyAt(1) == "other");
+        REQUIRE(deep.findSlot("deep1") == 1);
+        REQUIRE(first->transitionCount() == 2);
+    }
+
+    SECTION("Inline caches stay correct across shapes and keys")
+    {
+        Interpreter interpreter;
+        REQUIRE(interpreter.execute("get set set object \"a\" 1 \"b\" 2 \"b\"").asNumber() == 2.0);
+
+        // The last call site's cache is reused by direct calls
+        const FunctionEntry *get = interpreter.findFunction("get");
+        const FunctionEntry *set = interpreter.findFunction("set");
+        Value keyA("a");
+        Value keyB("b");
+        Object ab;
+        ab.set("a", Value(1.0));
+        ab.set("b", Value(2.0));
+        Object ba;
+        ba.set("b", Value(3.0));
+        ba.set("a", Value(4.0));
+
+        for (int i = 0; i < 3; ++i)
+        {
+            std::vector<Value> args = {Value(ab), keyA};
+            REQUIRE(get->invoke(args).asNumber() == 1.0);
+            args = {Value(ba), keyA};
+            REQUIRE(get->invoke(args).asNumber() == 4.0);
+            args = {Value(ab), keyB};
+            REQUIRE(get->invoke(args).asNumber() == 2.0);
+
+            args = {Value(Object()), keyA, Value(5.0)};
+            Value grown = set->invoke(args);
+            REQUIRE(grown.asObject().getShape() == Shape::empty()->withKey("a"));
+            REQUIRE(grown.asObject().find("a")->asNumber() == 5.0);
+            args = {grown, keyB, Value(6.0)};
+            REQUIRE(set->invoke(args).asObject().size() == 2);
+        }
+    }
+}
+
+TEST_CASE("Packed number arrays", "[value][vector]")
+{
+    SECTION("Arrays of numbers are packed automatically")
+    {
+        Value numbers(std::vector<Value>{Value(1.0), Value(2.0)});
+        REQUIRE(numbers.isArray());
+        REQUIRE(numbers.isNumberArray());
+        REQUIRE(numbers.asArray().size() == 2);
+        REQUIRE(numbers.arrayAt(1).asNumber() == 2.0);
+        REQUIRE(numbers == Value(std::vector<double>{1.0, 2.0}));
+        REQUIRE(numbers.toString() == "[1, 2]");
+        REQUIRE_FALSE(Value(std::vector<Value>{Value(1.0), Value("x")}).isNumberArray());
+
+        numbers.asArrayMutable().push_back(Value("x"));
+        REQUIRE_FALSE(numbers.isNumberArray());
+        REQUIRE(numbers.arraySize() == 3);
+    }
+
+    SECTION("Element-wise arithmetic broadcasts scalars")
+    {
+        Interpreter interpreter;
+        const std::string xs = "set set set array 0 1 1 2 2 3";
+        REQUIRE(interpreter.execute("plus " + xs + " 10").toString() == "[11, 12, 13]");
+        REQUIRE(interpreter.execute("minus 10 " + xs).toString() == "[9, 8, 7]");
+        REQUIRE(interpreter.execute("times " + xs + " " + xs).toString() == "[1, 4, 9]");
+        REQUIRE(interpreter.execute("divide " + xs + " 2").toString() == "[0.5, 1, 1.5]");
+        REQUIRE(interpreter.execute("power " + xs + " 2").toString() == "[1, 4, 9]");
+        REQUIRE(interpreter.execute("less " + xs + " 2").toString() == "[1, 0, 0]");
+        REQUIRE(interpreter.execute("greater " + xs + " 2").toString() == "[0, 0, 1]");
+        REQUIRE(interpreter.execute("type plus " + xs + " 1").asString() == "array");
+        REQUIRE(interpreter.execute("get set " + xs + " 1 \"b\" 1").asString() == "b");
+        REQUIRE_THROWS(interpreter.execute("plus " + xs + " set array 0 1"));
+    }
+
+    SECTION("Every backend matches the scalar kernels")
+    {
+        std::vector<double> a, b;
+        for (int i = 0; i < 37; ++i)
+        {
+            a.push_back(i * 0.5 - 4.0);
+            b.push_back(7.0 - i * 0.25);
+        }
+
+        auto original = VectorMath::getBackend();
+        for (auto op : {VectorMath::Op::Add, VectorMath::Op::Subtract, VectorMath::Op::Multiply, VectorMath::Op::Divide, VectorMath::Op::Power, VectorMath::Op::Less, VectorMath::Op::Greater, VectorMath::Op::Equal})
+        {
+            for (std::size_t n : {0, 1, 3, 4, 5, 37})
+            {
+                for (int mode = 0; mode < 3; ++mode)
+                {
+                    std::vector<double> expected(n), actual(n);
+                    VectorMath::setBackend(VectorMath::Backend::Scalar);
+                    VectorMath::apply(op, a.data(), mode == 1, b.data(), mode == 2, expected.data(), n);
+                    for (auto backend : {VectorMath::Backend::SSE2, VectorMath::Backend::AVX2})
+                    {
+                        if (!VectorMath::isSupported(backend))
+                        {
+                            continue;
+                        }
+                        VectorMath::setBackend(backend);
+                        VectorMath::apply(op, a.data(), mode == 1, b.data(), mode == 2, actual.data(), n);
+                        // Bitwise, so NaNs from pow compare equal
+                        REQUIRE(std::equal(actual.begin(), actual.end(), expected.begin(), [](double x, double y)
+                                           { return std::bit_cast<std::uint64_t>(x) == std::bit_cast<std::uint64_t>(y); }));
+                    }
+                }
+            }
+        }
+        VectorMath::setBackend(original);
+    }
+
+    SECTION("Selection vectors agree across backends")
+    {
+        std::vector<double> data;
+        for (int i = 0; i < 41; ++i)
+        {
+            data.push_back(static_cast<double>(i % 7));
+        }
+        data[5] = std::nan("");
+
+        auto original = VectorMath::getBackend();
+        for (auto op : {VectorMath::Op::Less, VectorMath::Op::Greater, VectorMath::Op::Equal})
+        {
+            for (std::size_t n : {0, 1, 3, 4, 5, 41})
+            {
+                std::vector<std::uint32_t> expected;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    bool keep = op == VectorMath::Op::Less ? data[i] < 3.0 : op == VectorMath::Op::Greater ? data[i] > 3.0 : data[i] == 3.0;
+                    if (keep)
+                    {
+                        expected.push_back(static_cast<std::uint32_t>(i));
+                    }
+                }
+                for (auto backend : {VectorMath::Backend::Scalar, VectorMath::Backend::SSE2, VectorMath::Backend::AVX2})
+                {
+                    if (!VectorMath::isSupported(backend))
+                    {
+                        continue;
+                    }
+                    VectorMath::setBackend(backend);
+                    std::vector<std::uint32_t> actual(n);
+                    actual.resize(VectorMath::select(op, data.data(), 3.0, actual.data(), n));
+                    REQUIRE(actual == expected);
+                }
+            }
+        }
+        VectorMath::setBackend(original);
+
+        bool threw = false;
+        try
+        {
+            std::uint32_t out[1];
+            VectorMath::select(VectorMath::Op::Add, data.data(), 3.0, out, 1);
+        }
+        catch (const std::runtime_error &)
+        {
+            threw = true;
+        }
+        REQUIRE(threw);
+    }
+}
+
+TEST_CASE("Reductions", "[builtins][vector]")
+{
+    SECTION("Builtins on packed and boxed arrays")
+    {
+        Interpreter interpreter;
+        const std::string xs = "set set set set array 0 3 1 -1 2 7 3 7";
+        REQUIRE(interpreter.execute("sum " + xs).asNumber() == 16.0);
+        REQUIRE(interpreter.execute("min " + xs).asNumber() == -1.0);
+        REQUIRE(interpreter.execute("max " + xs).asNumber() == 7.0);
+        REQUIRE(interpreter.execute("mean " + xs).asNumber() == 4.0);
+        REQUIRE(interpreter.execute("argmax " + xs).asNumber() == 2.0);
+        REQUIRE(interpreter.execute("count_if less " + xs + " 5").asNumber() == 2.0);
+        REQUIRE(interpreter.execute("dot " + xs + " " + xs).asNumber() == 108.0);
+
+        // Storing a string unboxes the array, which stays boxed after the
+        // string is overwritten; count_if counts truthy items
+        const std::string boxed = "set set set array 0 \"x\" 1 5 0 2";
+        REQUIRE(interpreter.execute(boxed).toString() == "[2, 5]");
+        REQUIRE(interpreter.execute("sum " + boxed).asNumber() == 7.0);
+        REQUIRE(interpreter.execute("argmax " + boxed).asNumber() == 1.0);
+        REQUIRE_THROWS(interpreter.execute("sum set array 0 \"x\""));
+        REQUIRE(interpreter.execute("count_if set set set array 0 0 1 \"x\" 2 \"\"").asNumber() == 1.0);
+
+        REQUIRE(interpreter.execute("sum array").asNumber() == 0.0);
+        REQUIRE(interpreter.execute("min array").isNull());
+        REQUIRE(interpreter.execute("mean array").isNull());
+        REQUIRE(interpreter.execute("argmax array").isNull());
+        REQUIRE_THROWS(interpreter.execute("sum 3"));
+        REQUIRE_THROWS(interpreter.execute("dot " + xs + " set array 0 1"));
+    }
+
+    SECTION("Summation is compensated")
+    {
+        // Naive left-to-right summation loses every 1.0 against 1e16
+        std::vector<double> values{1e16};
+        for (int i = 0; i < 1000; ++i)
+        {
+            values.push_back(1.0);
+        }
+        values.push_back(-1e16);
+
+        auto original = VectorMath::getBackend();
+        for (auto backend : {VectorMath::Backend::Scalar, VectorMath::Backend::SSE2, VectorMath::Backend::AVX2})
+        {
+            if (!VectorMath::isSupported(backend))
+            {
+                continue;
+            }
+            VectorMath::setBackend(backend);
+            REQUIRE(VectorMath::sum(values.data(), values.size()) == 1000.0);
+        }
+        VectorMath::setBackend(original);
+    }
+
+    SECTION("Every backend matches the scalar kernels")
+    {
+        // Small integers and halves, so every order of summation is exact
+        std::vector<double> a, b;
+        for (int i = 0; i < 37; ++i)
+        {
+            a.push_back((i * 7 % 19) * 0.5 - 4.0);
+            b.push_back(i % 3 == 0 ? 0.0 : 3.0 - i);
+        }
+        std::vector<double> withNaN = a;
+        withNaN[21] = std::numeric_limits<double>::quiet_NaN();
+
+        auto original = VectorMath::getBackend();
+        for (std::size_t n : {1, 2, 3, 4, 5, 8, 9, 37})
+        {
+            VectorMath::setBackend(VectorMath::Backend::Scalar);
+            const double sum = VectorMath::sum(a.data(), n);
+            const double dot = VectorMath::dot(a.data(), b.data(), n);
+            const double min = VectorMath::min(a.data(), n);
+            const double max = VectorMath::max(a.data(), n);
+            const std::size_t argmax = VectorMath::argmax(a.data(), n);
+            const std::size_t nonZero = VectorMath::countNonZero(b.data(), n);
+            for (auto backend : {VectorMath::Backend::SSE2, VectorMath::Backend::AVX2})
+            {
+                if (!VectorMath::isSupported(backend))
+                {
+                    continue;
+                }
+                VectorMath::setBackend(backend);
+                REQUIRE(VectorMath::sum(a.data(), n) == sum);
+                REQUIRE(VectorMath::dot(a.data(), b.data(), n) == dot);
+                REQUIRE(VectorMath::min(a.data(), n) == min);
+                REQUIRE(VectorMath::max(a.data(), n) == max);
+                REQUIRE(VectorMath::argmax(a.data(), n) == argmax);
+                REQUIRE(VectorMath::countNonZero(b.data(), n) == nonZero);
+                REQUIRE(std::isnan(VectorMath::max(withNaN.data(), 37)));
+                REQUIRE(std::isnan(VectorMath::min(withNaN.data(), 37)));
+                REQUIRE(VectorMath::argmax(withNaN.data(), 37) == 21);
+            }
+        }
+        VectorMath::setBackend(original);
+    }
+}
+
+TEST_CASE("Lazy sequences", "[builtins][sequence]")
+{
+    Interpreter interpreter;
+
+    SECTION("Stages compose without materializing")
+    {
+        REQUIRE(interpreter.execute("type range 0 5").asString() == "sequence");
+        REQUIRE(interpreter.execute("length range 0 5").asNumber() == 5.0);
+        REQUIRE(interpreter.execute("length range 0 2.5").asNumber() == 3.0);
+        REQUIRE(interpreter.execute("length range 5 0").asNumber() == 0.0);
+        REQUIRE(interpreter.execute("sum range 1 101").asNumber() == 5050.0);
+
+        // A large range is never stored; the stages run element by element
+        REQUIRE(interpreter.execute("length range 0 1e14").asNumber() == 1e14);
+        REQUIRE(interpreter.execute("sum take range 0 1e14 4").asNumber() == 6.0);
+
+        // Spans beyond an integer are clamped; infinite bounds are rejected
+        REQUIRE(interpreter.execute("length range 0 1e15").asInteger() == Value::MaxInteger);
+        REQUIRE(interpreter.execute("length range 0 1e300").asInteger() == Value::MaxInteger);
+        REQUIRE(interpreter.execute("length range -1e308 1e308").asInteger() == Value::MaxInteger);
+        REQUIRE(interpreter.execute("sum take range 0 1e300 3").asNumber() == 3.0);
+        REQUIRE_THROWS_AS(interpreter.execute("range 0 power 10 400"), std::runtime_error);
+        REQUIRE_THROWS_AS(interpreter.execute("range minus 0 power 10 400 0"), std::runtime_error);
+        REQUIRE_THROWS_AS(Sequence::range(0.0, std::nan("")), std::runtime_error);
+
+        // Squares below 50 among 0..9: 0 1 4 9 16 25 36 49
+        const std::string squares = "filter map range 0 10 \"power\" 2 \"less\" 50";
+        REQUIRE(interpreter.execute("length " + squares).asNumber() == 8.0);
+        REQUIRE(interpreter.execute("sum " + squares).asNumber() == 140.0);
+        REQUIRE(interpreter.execute("max " + squares).asNumber() == 49.0);
+        REQUIRE(interpreter.execute("argmax " + squares).asNumber() == 7.0);
+        REQUIRE(interpreter.execute("mean " + squares).asNumber() == 17.5);
+        REQUIRE(interpreter.execute("count_if " + squares).asNumber() == 7.0);
+        REQUIRE(interpreter.execute("min filter range 0 10 \"greater\" 20").isNull());
+    }
+
+    SECTION("Arrays feed sequences and zip pairs them up")
+    {
+        const std::string xs = "set set set array 0 3 1 1 2 2";
+        REQUIRE(interpreter.execute("sum map " + xs + " \"times\" 10").asNumber() == 60.0);
+        REQUIRE(interpreter.execute("length zip " + xs + " range 0 100").asNumber() == 3.0);
+        REQUIRE(interpreter.execute("dot " + xs + " range 1 4").asNumber() == 11.0);
+        REQUIRE(interpreter.execute("dot map range 0 3000 \"times\" 1 range 0 3000").asNumber() == 8995500500.0);
+        REQUIRE(interpreter.execute("count_if map zip " + xs + " range 0 3 \"length\" 0").asNumber() == 3.0);
+        REQUIRE_THROWS(interpreter.execute("dot " + xs + " range 0 4"));
+        REQUIRE_THROWS(interpreter.execute("map " + xs + " \"nonexistent\" 1"));
+        REQUIRE_THROWS(interpreter.execute("map " + xs + " \"if\" 1"));
+        REQUIRE_THROWS(interpreter.execute("sum map range 0 3 \"string\" 0"));
+    }
+
+    SECTION("each drives the stages once per element")
+    {
+        auto sink = std::make_unique<StringSink>();
+        StringSink &captured = *sink;
+        interpreter.setOutput(std::move(sink));
+        interpreter.execute("each map range 0 3 \"print\" 0 \"done\"");
+        REQUIRE(captured.str() == "012");
+    }
+}
+
+TEST_CASE("Copy-on-write collections", "[value][builtins]")
+{
+    Interpreter interpreter;
+    const FunctionEntry *set = interpreter.findFunction("set");
+
+    SECTION("set updates arrays and objects")
+    {
+        REQUIRE(interpreter.execute("length set set set array 0 \"a\" 1 \"b\" 0 \"c\"").asNumber() == 2.0);
+        REQUIRE(interpreter.execute("get set array 0 \"a\" 0").asString() == "a");
+        REQUIRE(interpreter.execute("get set object \"key\" 42 \"key\"").asNumber() == 42.0);
+        REQUIRE_THROWS(interpreter.execute("set array 5 \"gap\""));
+        REQUIRE_THROWS(interpreter.execute("set 1 2 3"));
+    }
+
+    SECTION("An unshared collection is updated in place")
+    {
+        std::vector<Value> args = {Value(std::vector<Value>{Value(1.0), Value("two")}), Value(0.0), Value(9.0)};
+        const Value *storage = args[0].asArray().data();
+
+        Value result = set->invoke(args);
+        REQUIRE(result.asArray().data() == storage);
+        REQUIRE(result.asArray()[0].asNumber() == 9.0);
+
+        args = {Value(std::vector<double>{1.0, 2.0}), Value(1.0), Value(9.0)};
+        const double *numbers = args[0].asNumberArray().data();
+        result = set->invoke(args);
+        REQUIRE(result.asNumberArray().data() == numbers);
+        REQUIRE(result.asNumberArray()[1] == 9.0);
+    }
+
+    SECTION("A shared collection is copied before the update")
+    {
+        Value original(std::vector<Value>{Value(1.0), Value(2.0)});
+        std::vector<Value> args = {original, Value(0.0), Value(9.0)};
+
+        Value result = set->invoke(args);
+        REQUIRE(result.asArray()[0].asNumber() == 9.0);
+        REQUIRE(original.asArray()[0].asNumber() == 1.0);
+        REQUIRE_FALSE(original.isShared());
+    }
+}